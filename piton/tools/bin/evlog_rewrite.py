@@ -0,0 +1,268 @@
+#!/usr/bin/python
+
+###########################################################################
+#Copyright (c) 2015 Princeton University
+#All rights reserved.
+#
+#Redistribution and use in source and binary forms, with or without
+#modification, are permitted provided that the following conditions are met:
+#    * Redistributions of source code must retain the above copyright
+#      notice, this list of conditions and the following disclaimer.
+#    * Redistributions in binary form must reproduce the above copyright
+#      notice, this list of conditions and the following disclaimer in the
+#      documentation and/or other materials provided with the distribution.
+#    * Neither the name of Princeton University nor the
+#      names of its contributors may be used to endorse or promote products
+#      derived from this software without specific prior written permission.
+#
+#THIS SOFTWARE IS PROVIDED BY PRINCETON UNIVERSITY "AS IS" AND
+#ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+#WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+#DISCLAIMED. IN NO EVENT SHALL PRINCETON UNIVERSITY BE LIABLE FOR ANY
+#DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+#(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+#LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+#ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+#(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+#SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+##############################################################################
+
+# Rewrites the $display and $write calls of a monitor into the DPI-C
+# calls of the binary event log (tools/pli/evlog, used by sims -evlog):
+#
+#   evlog_rewrite.py SRC SOURCE_ID SOURCE_NAME > OUT
+#
+# Each call site becomes an event numbered within the source, with the
+# format of the call and the arguments passed with their widths, e.g.
+#
+#   $display("addr: 0x%h", addr);
+#   evlog_1(65537, "addr: 0x%h\n", $time, $bits(addr), addr);
+#
+# tools/src/evlog_dec prints the same text from the log. Calls the decoder
+# can not reproduce (%m, %e, %f, %g, %v, %l, %u, %z) and calls reporting a
+# failure or a pass, which the regression scripts look for in sim.log,
+# are left as they are. A module with rewritten calls includes evlog.vh
+# and names its source in the initializer of a module variable, which runs
+# before its initial and always blocks. The log is +evlog_file=NAME
+# (monitors.evlog by default), opened by the first call of the library.
+
+import sys
+import re
+
+MAX_FIELDS = 8
+KEEP_TEXT = re.compile(r'FAIL|PASS|ERROR|Error|WARN|Warn')
+SPEC = re.compile(r'%%|%[-0-9]*([a-zA-Z])')
+SPEC_OK = 'bBoOdDhHxXcCsStT'
+
+
+def skip_space(text, i):
+    while i < len(text):
+        if text[i].isspace():
+            i += 1
+        elif text.startswith('//', i):
+            j = text.find('\n', i)
+            i = len(text) if j < 0 else j
+        elif text.startswith('/*', i):
+            j = text.find('*/', i + 2)
+            i = len(text) if j < 0 else j + 2
+        else:
+            break
+    return i
+
+
+def skip_string(text, i):
+    # i is at the opening quote, returns the index after the closing one
+    i += 1
+    while i < len(text) and text[i] != '"':
+        i += 2 if text[i] == '\\' else 1
+    return i + 1
+
+
+def split_args(text, i):
+    # i is at '(', returns the arguments and the index after ')'
+    args = []
+    depth = 0
+    start = i + 1
+    i += 1
+    while i < len(text):
+        c = text[i]
+        if c == '"':
+            i = skip_string(text, i)
+            continue
+        if text.startswith('//', i) or text.startswith('/*', i):
+            i = skip_space(text, i)
+            continue
+        if c in '([{':
+            depth += 1
+        elif c in ')]}':
+            if depth == 0:
+                args.append(text[start:i].strip())
+                return args, i + 1
+            depth -= 1
+        elif c == ',' and depth == 0:
+            args.append(text[start:i].strip())
+            start = i + 1
+        i += 1
+    return None, i
+
+
+def is_literal(arg):
+    return arg.startswith('"') and skip_string(arg, 0) == len(arg)
+
+
+def format_call(task, args):
+    # the format pieces, each ends with the conversion of a field, or None
+    # when the call is left as it is
+    if args == ['']:
+        args = []
+    pieces = []
+    text = ''
+    fields = []
+    pending = 0
+    for arg in args:
+        if arg == '':
+            return None
+        if is_literal(arg) and KEEP_TEXT.search(arg):
+            return None
+        if pending:
+            fields.append(arg)
+            pending -= 1
+            if pending == 0:
+                pieces.append(text)
+                text = ''
+            continue
+        if is_literal(arg):
+            body = arg[1:-1]
+            pos = 0
+            for m in SPEC.finditer(body):
+                if m.group(0) == '%%':
+                    continue
+                if m.group(1) not in SPEC_OK:
+                    return None
+                # every piece keeps one conversion
+                if pending:
+                    pieces.append(text + body[pos:m.start()])
+                    text = ''
+                    pos = m.start()
+                pending += 1
+            text += body[pos:]
+        else:
+            # an argument without a format prints in decimal
+            fields.append(arg)
+            pieces.append(text + '%d')
+            text = ''
+    if pending:
+        return None
+    if task == '$display':
+        text += '\\n'
+    return pieces, text, fields
+
+
+def emit(site, fmt, fields):
+    call = 'evlog_%d(%d, "%s", $time' % (len(fields), site, fmt)
+    for f in fields:
+        call += ', $bits(%s), %s' % (f, f)
+    return call + ');'
+
+
+def rewrite(text, source):
+    out = []
+    event = [0]
+    modules = []  # (header end, endmodule start) of modules with events
+    module_start = None
+    module_events = False
+    i = 0
+    last = 0
+    word = re.compile(r'[A-Za-z_$][A-Za-z0-9_$]*')
+    while i < len(text):
+        c = text[i]
+        if c == '"':
+            i = skip_string(text, i)
+            continue
+        if text.startswith('//', i) or text.startswith('/*', i):
+            i = skip_space(text, i)
+            continue
+        m = word.match(text, i)
+        if not m:
+            i += 1
+            continue
+        name = m.group(0)
+        i = m.end()
+        if name in ('module', 'macromodule'):
+            module_start = text.find(';', i) + 1
+            module_events = False
+        elif name == 'endmodule':
+            if module_events:
+                modules.append((module_start, m.start()))
+            module_events = False
+        elif name in ('$display', '$write'):
+            j = skip_space(text, i)
+            if j < len(text) and text[j] == ';':
+                args, end = [], j + 1
+            elif j < len(text) and text[j] == '(':
+                args, end = split_args(text, j)
+                if args is None:
+                    continue
+                end = skip_space(text, end)
+                if end >= len(text) or text[end] != ';':
+                    continue
+                end += 1
+            else:
+                continue
+            call = format_call(name, args)
+            if call is None:
+                i = end
+                continue
+            pieces, tail, fields = call
+            # the event number is 16 bits, the rest of a large
+            # configuration stays on $display
+            if event[0] + (len(fields) + MAX_FIELDS - 1) // MAX_FIELDS >= 0xffff:
+                i = end
+                continue
+            # more fields than an evlog_<n> takes make several events, the
+            # newline goes with the last
+            calls = []
+            for k in range(0, max(len(fields), 1), MAX_FIELDS):
+                fmt = ''.join(pieces[k:k + MAX_FIELDS])
+                if k + MAX_FIELDS >= len(fields):
+                    fmt += tail
+                event[0] += 1
+                calls.append(emit(source << 16 | event[0], fmt,
+                                  fields[k:k + MAX_FIELDS]))
+            # several events stay one statement, the $display may be the
+            # body of an if or a loop; a call keeps its lines
+            repl = ' '.join(calls)
+            if len(calls) > 1:
+                repl = 'begin ' + repl + ' end'
+            repl += '\n' * text[m.start():end].count('\n')
+            out.append(text[last:m.start()])
+            out.append(repl)
+            last = end
+            i = end
+            module_events = True
+    out.append(text[last:])
+    return ''.join(out), modules, event[0]
+
+
+def main():
+    if len(sys.argv) != 4:
+        sys.stderr.write('usage: evlog_rewrite.py SRC SOURCE_ID SOURCE_NAME\n')
+        sys.exit(1)
+    src = open(sys.argv[1]).read()
+    source = int(sys.argv[2])
+    name = sys.argv[3]
+
+    # the positions of the modules are in the source, the calls are
+    # rewritten in a second pass to keep them valid
+    _, modules, _ = rewrite(src, source)
+    init = 'int evlog_init = evlog_source(%d, "%s");\n' % (source, name)
+    for header, end in reversed(modules):
+        src = src[:end] + init + src[end:]
+        src = src[:header] + '\n`include "evlog.vh"\n' + src[header:]
+    text, _, events = rewrite(src, source)
+    sys.stdout.write(text)
+    sys.stderr.write('evlog_rewrite.py: %s: %d events\n' % (name, events))
+
+
+if __name__ == '__main__':
+    main()
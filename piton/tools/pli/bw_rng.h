@@ -0,0 +1,78 @@
+/*
+Copyright (c) 2019 Princeton University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Princeton University nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY PRINCETON UNIVERSITY "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL PRINCETON UNIVERSITY BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/*******************************************************************************
+    bw_rng.h
+********************************************************************************
+Small PCG32 generator for the PLI/DPI models.
+
+Each user keeps its own bw_rng, seeded from +tg_seed= and a stream id, so
+the sequence it sees does not depend on how many numbers other modules
+have drawn from libc random(). No locking, no global state.
+*/
+#ifndef _BW_RNG_H_
+#define _BW_RNG_H_
+
+//stream classes, the low 32 bits of a stream are free for an instance number
+//(pcx, cpx) or a hash of the target (slam).
+#define BW_RNG_STREAM_PCX   1ULL
+#define BW_RNG_STREAM_CPX   2ULL
+#define BW_RNG_STREAM_SLAM  3ULL
+#define BW_RNG_STREAM(cls, num) (((cls) << 32) | ((num) & 0xffffffffULL))
+
+typedef struct bw_rng{
+  unsigned long long state;
+  unsigned long long inc;
+} bw_rng;
+
+/*------------------------------------------
+ next 32 bit random number.
+-------------------------------------------*/
+static inline unsigned int bw_rng_next(bw_rng* rng)
+{
+  unsigned long long old = rng->state;
+  unsigned int xorshifted, rot;
+
+  rng->state = old * 6364136223846793005ULL + rng->inc;
+  xorshifted = (unsigned int)(((old >> 18) ^ old) >> 27);
+  rot        = (unsigned int)(old >> 59);
+  return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+}
+
+/*------------------------------------------
+ seed a generator, different streams give
+ independent sequences for the same seed.
+-------------------------------------------*/
+static inline void bw_rng_seed(bw_rng* rng, unsigned long long seed,
+                               unsigned long long stream)
+{
+  rng->state = 0;
+  rng->inc   = (stream << 1) | 1;
+  bw_rng_next(rng);
+  rng->state += seed;
+  bw_rng_next(rng);
+}
+#endif
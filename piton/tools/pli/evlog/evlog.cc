@@ -0,0 +1,256 @@
+/*
+Copyright (c) 2019 Princeton University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Princeton University nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY PRINCETON UNIVERSITY "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL PRINCETON UNIVERSITY BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Binary event log of the verification monitors, see evlog.h.
+
+#include "evlog.h"
+#include <errno.h>
+#include <string.h>
+
+// the buffer is written out when it has this much
+static const size_t evlog_buffer = 1 << 20;
+
+bool evlog_writer::open(const std::string& name) {
+    close();
+    file = fopen(name.c_str(), "wb");
+    if (!file) {
+        err = "can not open '" + name + "': " + strerror(errno);
+        return false;
+    }
+    this->name = name;
+    buf.clear();
+    buf.reserve(evlog_buffer + 4096);
+    sites.clear();
+    records = 0;
+
+    evlog_header hdr;
+    hdr.magic = EVLOG_MAGIC;
+    hdr.version = EVLOG_VERSION;
+    put(&hdr, sizeof(hdr));
+    return true;
+}
+
+void evlog_writer::put(const void* data, size_t size) {
+    const char* p = (const char*) data;
+    buf.insert(buf.end(), p, p + size);
+}
+
+void evlog_writer::flush() {
+    if (file && !buf.empty()) {
+        fwrite(&buf[0], 1, buf.size(), file);
+        buf.clear();
+    }
+}
+
+void evlog_writer::close() {
+    if (file) {
+        flush();
+        fclose(file);
+        file = NULL;
+    }
+}
+
+void evlog_writer::source(uint32_t id, const char* name) {
+    if (!file) {
+        return;
+    }
+    uint8_t kind = EVLOG_SOURCE;
+    uint16_t src = id;
+    uint16_t len = strlen(name);
+    put(&kind, 1);
+    put(&src, 2);
+    put(&len, 2);
+    put(name, len);
+}
+
+void evlog_writer::event(uint32_t site, const char* format, int fields, const uint32_t* widths) {
+    if (!file) {
+        return;
+    }
+    uint32_t src = evlog_source_of(site), ev = evlog_event_of(site);
+    if (src >= sites.size()) {
+        sites.resize(src + 1);
+    }
+    if (ev >= sites[src].size()) {
+        sites[src].resize(ev + 1);
+    }
+    sites[src][ev] = true;
+
+    uint8_t kind = EVLOG_EVENT;
+    uint8_t n = fields;
+    uint16_t len = strlen(format);
+    put(&kind, 1);
+    put(&site, 4);
+    put(&n, 1);
+    for (int i = 0; i < fields; i++) {
+        uint16_t w = widths[i] < EVLOG_MAX_WIDTH ? widths[i] : EVLOG_MAX_WIDTH;
+        put(&w, 2);
+    }
+    put(&len, 2);
+    put(format, len);
+}
+
+void evlog_writer::record(uint32_t site, uint64_t time, int fields, const uint32_t* widths,
+                          const uint32_t* const* values) {
+    if (!file) {
+        return;
+    }
+    uint8_t kind = EVLOG_RECORD;
+    put(&kind, 1);
+    put(&site, 4);
+    put(&time, 8);
+    for (int i = 0; i < fields; i++) {
+        uint32_t words = evlog_words(widths[i]);
+        uint32_t val[EVLOG_MAX_WIDTH / 32 * 2];
+        uint8_t state = EVLOG_2STATE;
+        // svLogicVecVal pairs to aval words then bval words, the bits
+        // above the width are cleared
+        for (uint32_t w = 0; w < words; w++) {
+            uint32_t mask = ~0u;
+            if (w == words - 1 && widths[i] < EVLOG_MAX_WIDTH && widths[i] % 32) {
+                mask = (1u << (widths[i] % 32)) - 1;
+            }
+            val[w] = values[i][2 * w] & mask;
+            val[words + w] = values[i][2 * w + 1] & mask;
+            if (val[words + w]) {
+                state = EVLOG_4STATE;
+            }
+        }
+        put(&state, 1);
+        put(val, (state == EVLOG_4STATE ? 2 : 1) * words * sizeof(uint32_t));
+    }
+    records++;
+    if (buf.size() >= evlog_buffer) {
+        flush();
+    }
+}
+
+bool evlog_reader::open(const std::string& name) {
+    close();
+    err.clear();
+    sites.clear();
+    file = fopen(name.c_str(), "rb");
+    if (!file) {
+        err = "can not open '" + name + "': " + strerror(errno);
+        return false;
+    }
+    setvbuf(file, NULL, _IOFBF, evlog_buffer);
+    evlog_header hdr;
+    if (fread(&hdr, sizeof(hdr), 1, file) != 1 || hdr.magic != EVLOG_MAGIC) {
+        err = name + " is not an event log";
+        close();
+        return false;
+    }
+    if (hdr.version != EVLOG_VERSION) {
+        err = name + " is an event log of another version";
+        close();
+        return false;
+    }
+    return true;
+}
+
+void evlog_reader::close() {
+    if (file) {
+        fclose(file);
+        file = NULL;
+    }
+}
+
+bool evlog_reader::get(void* data, size_t size) {
+    if (fread(data, 1, size, file) != size) {
+        err = "truncated event log";
+        return false;
+    }
+    return true;
+}
+
+bool evlog_reader::next(evlog_item& item) {
+    uint8_t kind;
+    if (!file || fread(&kind, 1, 1, file) != 1) {
+        return false;
+    }
+    item.kind = kind;
+    if (kind == EVLOG_SOURCE) {
+        uint16_t src, len;
+        if (!get(&src, 2) || !get(&len, 2)) {
+            return false;
+        }
+        item.source = src;
+        item.text.resize(len);
+        return !len || get(&item.text[0], len);
+    } else if (kind == EVLOG_EVENT) {
+        uint8_t n;
+        uint16_t len;
+        if (!get(&item.site, 4) || !get(&n, 1)) {
+            return false;
+        }
+        item.widths.resize(n);
+        for (int i = 0; i < n; i++) {
+            uint16_t w;
+            if (!get(&w, 2)) {
+                return false;
+            }
+            item.widths[i] = w;
+        }
+        if (!get(&len, 2)) {
+            return false;
+        }
+        item.text.resize(len);
+        if (len && !get(&item.text[0], len)) {
+            return false;
+        }
+        sites[item.site] = item.widths;
+        return true;
+    } else if (kind == EVLOG_RECORD) {
+        if (!get(&item.site, 4) || !get(&item.time, 8)) {
+            return false;
+        }
+        std::map<uint32_t, std::vector<uint32_t> >::const_iterator it = sites.find(item.site);
+        if (it == sites.end()) {
+            err = "record of an undefined event";
+            return false;
+        }
+        item.widths = it->second;
+        item.aval.resize(item.widths.size());
+        item.bval.resize(item.widths.size());
+        for (size_t i = 0; i < item.widths.size(); i++) {
+            uint32_t words = evlog_words(item.widths[i]);
+            uint8_t state;
+            item.aval[i].resize(words);
+            item.bval[i].assign(words, 0);
+            if (!get(&state, 1) || (words && !get(&item.aval[i][0], words * 4))) {
+                return false;
+            }
+            if (state == EVLOG_4STATE && words && !get(&item.bval[i][0], words * 4)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    err = "bad item in the event log";
+    return false;
+}
@@ -0,0 +1,160 @@
+/*
+Copyright (c) 2019 Princeton University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Princeton University nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY PRINCETON UNIVERSITY "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL PRINCETON UNIVERSITY BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Binary event log of the verification monitors.
+//
+// With sims -evlog the $display and $write calls of the monitors
+// (cmp_l15_messages_mon, l2_mon, lsu_mon2, tlu_mon) are rewritten by
+// tools/bin/evlog_rewrite.py into calls of the DPI-C functions of
+// evlog_dpi.cc. Every call site is an event, numbered by the rewrite
+// within its monitor (the source), with the format string of the call and
+// the widths of its arguments. A record keeps the simulation time, the
+// source and event ids and the 4-state argument values, the format is
+// applied offline by tools/src/evlog_dec, which prints the text the
+// monitor would have printed.
+//
+// File layout, host byte order (the simulation hosts are little endian):
+//   evlog_header
+//   then items, each starting with a kind byte
+//   EVLOG_SOURCE  u16 source, u16 length, the name
+//   EVLOG_EVENT   u32 site, u8 fields, u16 width of every field,
+//                 u16 length, the format
+//   EVLOG_RECORD  u32 site, u64 time, for every field a u8 state
+//                 (EVLOG_2STATE or EVLOG_4STATE) and the aval words,
+//                 least significant first, followed by the bval words of
+//                 a 4-state value
+// The site of an event is source << 16 | event. A source and the events of
+// a site come before their first record. Fields are at most
+// EVLOG_MAX_WIDTH bits, the bits above are dropped.
+
+#ifndef EVLOG_H
+#define EVLOG_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#define EVLOG_MAGIC       0x314c5645u  // "EVL1"
+#define EVLOG_VERSION     1
+#define EVLOG_MAX_WIDTH   512
+#define EVLOG_MAX_FIELDS  8
+
+#define EVLOG_SOURCE      1
+#define EVLOG_EVENT       2
+#define EVLOG_RECORD      3
+
+#define EVLOG_2STATE      0
+#define EVLOG_4STATE      1
+
+struct evlog_header {
+    uint32_t magic;
+    uint32_t version;
+};
+
+static inline uint32_t evlog_source_of(uint32_t site) {
+    return site >> 16;
+}
+
+static inline uint32_t evlog_event_of(uint32_t site) {
+    return site & 0xffff;
+}
+
+// 32 bit words of a field of width bits
+static inline uint32_t evlog_words(uint32_t width) {
+    return ((width < EVLOG_MAX_WIDTH ? width : EVLOG_MAX_WIDTH) + 31) / 32;
+}
+
+class evlog_writer {
+public:
+    evlog_writer() : file(NULL), records(0) {}
+    ~evlog_writer() { close(); }
+
+    bool open(const std::string& name);
+    bool is_open() const { return file != NULL; }
+    void close();
+
+    void source(uint32_t id, const char* name);
+    // the definition of a site, written before its first record
+    void event(uint32_t site, const char* format, int fields, const uint32_t* widths);
+    bool defined(uint32_t site) const {
+        uint32_t src = evlog_source_of(site), ev = evlog_event_of(site);
+        return src < sites.size() && ev < sites[src].size() && sites[src][ev];
+    }
+    // values[i] points to the aval/bval pairs of field i (svLogicVecVal)
+    void record(uint32_t site, uint64_t time, int fields, const uint32_t* widths,
+                const uint32_t* const* values);
+
+    const std::string& error() const { return err; }
+    uint64_t count() const { return records; }
+
+private:
+    void put(const void* data, size_t size);
+    void flush();
+
+    FILE* file;
+    std::string name;
+    std::string err;
+    std::vector<char> buf;
+    std::vector<std::vector<bool> > sites;
+    uint64_t records;
+};
+
+// an item of the log, the members of its kind are set
+struct evlog_item {
+    int kind;
+    uint32_t source;                 // EVLOG_SOURCE
+    std::string text;                // the name of a source, the format of an event
+    uint32_t site;                   // EVLOG_EVENT, EVLOG_RECORD
+    std::vector<uint32_t> widths;    // EVLOG_EVENT, EVLOG_RECORD
+    uint64_t time;                   // EVLOG_RECORD
+    // aval and bval words of every field, bval is 0 for 2-state values
+    std::vector<std::vector<uint32_t> > aval, bval;
+};
+
+class evlog_reader {
+public:
+    evlog_reader() : file(NULL) {}
+    ~evlog_reader() { close(); }
+
+    bool open(const std::string& name);
+    void close();
+    // false at the end of the log or on an error, error() is empty at the end
+    bool next(evlog_item& item);
+
+    const std::string& error() const { return err; }
+
+private:
+    bool get(void* data, size_t size);
+
+    FILE* file;
+    std::string err;
+    std::map<uint32_t, std::vector<uint32_t> > sites;
+};
+
+#endif // EVLOG_H
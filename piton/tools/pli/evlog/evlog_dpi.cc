@@ -0,0 +1,227 @@
+/*
+Copyright (c) 2019 Princeton University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Princeton University nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY PRINCETON UNIVERSITY "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL PRINCETON UNIVERSITY BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// DPI-C adapter of evlog.h, the imports are in verif/env/manycore/evlog.vh.
+// evlog_source() names a monitor, evlog_<n>() logs one event with n fields.
+// The first call of either opens the log, +evlog_file=NAME (monitors.evlog
+// by default), so events of time 0 are kept whichever process runs first.
+// The widths of the fields and the format are written once per site, with
+// its first record.
+
+#include "evlog.h"
+#include "svdpi.h"
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#ifdef VERILATOR
+#include "verilated.h"
+#else // ifdef VERILATOR
+#include "vpi_user.h"
+#endif // ifdef VERILATOR
+
+extern "C" int evlog_source(int id, const char* name);
+extern "C" void evlog_0(int site, const char* format, unsigned long long time);
+extern "C" void evlog_1(int site, const char* format, unsigned long long time,
+                        int w0, const svLogicVecVal* a0);
+extern "C" void evlog_2(int site, const char* format, unsigned long long time,
+                        int w0, const svLogicVecVal* a0, int w1, const svLogicVecVal* a1);
+extern "C" void evlog_3(int site, const char* format, unsigned long long time,
+                        int w0, const svLogicVecVal* a0, int w1, const svLogicVecVal* a1,
+                        int w2, const svLogicVecVal* a2);
+extern "C" void evlog_4(int site, const char* format, unsigned long long time,
+                        int w0, const svLogicVecVal* a0, int w1, const svLogicVecVal* a1,
+                        int w2, const svLogicVecVal* a2, int w3, const svLogicVecVal* a3);
+extern "C" void evlog_5(int site, const char* format, unsigned long long time,
+                        int w0, const svLogicVecVal* a0, int w1, const svLogicVecVal* a1,
+                        int w2, const svLogicVecVal* a2, int w3, const svLogicVecVal* a3,
+                        int w4, const svLogicVecVal* a4);
+extern "C" void evlog_6(int site, const char* format, unsigned long long time,
+                        int w0, const svLogicVecVal* a0, int w1, const svLogicVecVal* a1,
+                        int w2, const svLogicVecVal* a2, int w3, const svLogicVecVal* a3,
+                        int w4, const svLogicVecVal* a4, int w5, const svLogicVecVal* a5);
+extern "C" void evlog_7(int site, const char* format, unsigned long long time,
+                        int w0, const svLogicVecVal* a0, int w1, const svLogicVecVal* a1,
+                        int w2, const svLogicVecVal* a2, int w3, const svLogicVecVal* a3,
+                        int w4, const svLogicVecVal* a4, int w5, const svLogicVecVal* a5,
+                        int w6, const svLogicVecVal* a6);
+extern "C" void evlog_8(int site, const char* format, unsigned long long time,
+                        int w0, const svLogicVecVal* a0, int w1, const svLogicVecVal* a1,
+                        int w2, const svLogicVecVal* a2, int w3, const svLogicVecVal* a3,
+                        int w4, const svLogicVecVal* a4, int w5, const svLogicVecVal* a5,
+                        int w6, const svLogicVecVal* a6, int w7, const svLogicVecVal* a7);
+
+static evlog_writer evlog;
+static bool evlog_tried = false;
+static std::map<uint32_t, std::string> evlog_sources;
+
+static void evlog_exit() {
+    if (evlog.is_open()) {
+        printf("evlog: %llu records\n", (unsigned long long) evlog.count());
+    }
+    evlog.close();
+}
+
+// the value of +evlog_file=, from the simulator as $value$plusargs would
+static const char* evlog_file() {
+    static const char plusarg[] = "evlog_file=";
+#ifdef VERILATOR
+    const char* match = Verilated::commandArgsPlusMatch(plusarg);
+    if (match[0]) {
+        return match + 1 + strlen(plusarg);
+    }
+#else // ifdef VERILATOR
+    s_vpi_vlog_info info;
+    if (vpi_get_vlog_info(&info)) {
+        for (int i = 1; i < info.argc; i++) {
+            const char* arg = info.argv[i];
+            if (arg && arg[0] == '+' && !strncmp(arg + 1, plusarg, strlen(plusarg))) {
+                return arg + 1 + strlen(plusarg);
+            }
+        }
+    }
+#endif // ifdef VERILATOR
+    return "monitors.evlog";
+}
+
+static void evlog_start() {
+    evlog_tried = true;
+    const char* file = evlog_file();
+    if (evlog.open(file)) {
+        printf("evlog: monitor events in %s\n", file);
+        atexit(evlog_exit);
+    } else {
+        printf("Error: evlog %s, monitor events are dropped\n", evlog.error().c_str());
+    }
+}
+
+// the return value lets the rewrite call it from the initializer of a
+// module variable, which runs before the initial and always blocks
+int evlog_source(int id, const char* name) {
+    if (!evlog_tried) {
+        evlog_start();
+    }
+    // a source first seen by a record has no name until its monitor names
+    // it, the decoder keeps the last name
+    std::map<uint32_t, std::string>::iterator it = evlog_sources.find(id);
+    if (it == evlog_sources.end() || (name[0] && it->second != name)) {
+        evlog_sources[id] = name;
+        evlog.source(id, name);
+    }
+    return 1;
+}
+
+static void evlog_put(int site, const char* format, unsigned long long time, int fields,
+                      const int* w, const svLogicVecVal* const* a) {
+    uint32_t widths[EVLOG_MAX_FIELDS];
+    const uint32_t* values[EVLOG_MAX_FIELDS];
+    if (!evlog_tried) {
+        evlog_start();
+    }
+    if (!evlog_sources.count(evlog_source_of(site))) {
+        evlog_source(evlog_source_of(site), "");
+    }
+    for (int i = 0; i < fields; i++) {
+        widths[i] = w[i];
+        values[i] = (const uint32_t*) a[i];
+    }
+    if (!evlog.defined(site)) {
+        evlog.event(site, format, fields, widths);
+    }
+    evlog.record(site, time, fields, widths, values);
+}
+
+void evlog_0(int site, const char* format, unsigned long long time) {
+    evlog_put(site, format, time, 0, NULL, NULL);
+}
+
+void evlog_1(int site, const char* format, unsigned long long time,
+             int w0, const svLogicVecVal* a0) {
+    int w[] = {w0};
+    const svLogicVecVal* a[] = {a0};
+    evlog_put(site, format, time, 1, w, a);
+}
+
+void evlog_2(int site, const char* format, unsigned long long time,
+             int w0, const svLogicVecVal* a0, int w1, const svLogicVecVal* a1) {
+    int w[] = {w0, w1};
+    const svLogicVecVal* a[] = {a0, a1};
+    evlog_put(site, format, time, 2, w, a);
+}
+
+void evlog_3(int site, const char* format, unsigned long long time,
+             int w0, const svLogicVecVal* a0, int w1, const svLogicVecVal* a1,
+             int w2, const svLogicVecVal* a2) {
+    int w[] = {w0, w1, w2};
+    const svLogicVecVal* a[] = {a0, a1, a2};
+    evlog_put(site, format, time, 3, w, a);
+}
+
+void evlog_4(int site, const char* format, unsigned long long time,
+             int w0, const svLogicVecVal* a0, int w1, const svLogicVecVal* a1,
+             int w2, const svLogicVecVal* a2, int w3, const svLogicVecVal* a3) {
+    int w[] = {w0, w1, w2, w3};
+    const svLogicVecVal* a[] = {a0, a1, a2, a3};
+    evlog_put(site, format, time, 4, w, a);
+}
+
+void evlog_5(int site, const char* format, unsigned long long time,
+             int w0, const svLogicVecVal* a0, int w1, const svLogicVecVal* a1,
+             int w2, const svLogicVecVal* a2, int w3, const svLogicVecVal* a3,
+             int w4, const svLogicVecVal* a4) {
+    int w[] = {w0, w1, w2, w3, w4};
+    const svLogicVecVal* a[] = {a0, a1, a2, a3, a4};
+    evlog_put(site, format, time, 5, w, a);
+}
+
+void evlog_6(int site, const char* format, unsigned long long time,
+             int w0, const svLogicVecVal* a0, int w1, const svLogicVecVal* a1,
+             int w2, const svLogicVecVal* a2, int w3, const svLogicVecVal* a3,
+             int w4, const svLogicVecVal* a4, int w5, const svLogicVecVal* a5) {
+    int w[] = {w0, w1, w2, w3, w4, w5};
+    const svLogicVecVal* a[] = {a0, a1, a2, a3, a4, a5};
+    evlog_put(site, format, time, 6, w, a);
+}
+
+void evlog_7(int site, const char* format, unsigned long long time,
+             int w0, const svLogicVecVal* a0, int w1, const svLogicVecVal* a1,
+             int w2, const svLogicVecVal* a2, int w3, const svLogicVecVal* a3,
+             int w4, const svLogicVecVal* a4, int w5, const svLogicVecVal* a5,
+             int w6, const svLogicVecVal* a6) {
+    int w[] = {w0, w1, w2, w3, w4, w5, w6};
+    const svLogicVecVal* a[] = {a0, a1, a2, a3, a4, a5, a6};
+    evlog_put(site, format, time, 7, w, a);
+}
+
+void evlog_8(int site, const char* format, unsigned long long time,
+             int w0, const svLogicVecVal* a0, int w1, const svLogicVecVal* a1,
+             int w2, const svLogicVecVal* a2, int w3, const svLogicVecVal* a3,
+             int w4, const svLogicVecVal* a4, int w5, const svLogicVecVal* a5,
+             int w6, const svLogicVecVal* a6, int w7, const svLogicVecVal* a7) {
+    int w[] = {w0, w1, w2, w3, w4, w5, w6, w7};
+    const svLogicVecVal* a[] = {a0, a1, a2, a3, a4, a5, a6, a7};
+    evlog_put(site, format, time, 8, w, a);
+}
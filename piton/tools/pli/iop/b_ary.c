@@ -189,3 +189,37 @@ b_tree_atom_ptr b_Find(b_tree_node_ptr* p,
   }
   return (*p)->data[index];
 }
+/*--------------------------------------------
+visit all atoms of the tree in key order.
+data is held in data[1..size], the children
+in child[0..size].
+---------------------------------------------*/
+int b_walk(b_tree_node_ptr node,
+	   int (*fn)(b_tree_atom_ptr atom, void* arg),
+	   void* arg)
+{
+  int i, ret;
+
+  if(node == 0)return 0;
+  if((ret = b_walk(node->child[0], fn, arg)))return ret;
+  for(i = 1; i <= node->size; i++){
+    if((ret = fn(node->data[i], arg)))return ret;
+    if((ret = b_walk(node->child[i], fn, arg)))return ret;
+  }
+  return 0;
+}
+/*--------------------------------------------
+free the tree and its atoms.
+---------------------------------------------*/
+void b_destroy(b_tree_node_ptr node)
+{
+  int i;
+
+  if(node == 0)return;
+  b_destroy(node->child[0]);
+  for(i = 1; i <= node->size; i++){
+    free(node->data[i]);
+    b_destroy(node->child[i]);
+  }
+  free(node);
+}
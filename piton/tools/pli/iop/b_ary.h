@@ -76,6 +76,12 @@ extern "C" {
   // used in update and from user
   b_tree_atom_ptr b_Find(b_tree_node_ptr* p,
 			 KeyType* key);
+  // visit every atom in key order, stops when fn returns non zero.
+  int  b_walk(b_tree_node_ptr node,
+	      int (*fn)(b_tree_atom_ptr atom, void* arg),
+	      void* arg);
+  // free the tree and its atoms.
+  void b_destroy(b_tree_node_ptr node);
 #ifdef __cplusplus
 }
 #endif
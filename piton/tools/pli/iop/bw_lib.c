@@ -194,19 +194,18 @@ void read_mem(char*              str,
     }
     fclose(fp);
 }
+static unsigned int tg_seed = 0;
+
 /*------------------------------------------
-set random seed
+seed for the per-object generators (bw_rng.h).
+the adapters pass +tg_seed= through set_tg_seed.
 -------------------------------------------*/
-#ifndef PITON_DPI
-void set_random()
+void set_tg_seed(unsigned int seed)
 {
-    char  *pargs;
-    unsigned int seed;
-    pargs = mc_scan_plusargs ((char *)"tg_seed=");  
-    if(pargs != (char *) 0) {
-        seed = atoi(pargs);
-        srand(seed);
-        srandom(seed);
-    }
+    tg_seed = seed;
+}
+
+unsigned int get_tg_seed()
+{
+    return tg_seed;
 }
-#endif
@@ -47,7 +47,8 @@ extern "C" {
   int     align_buf(char* cbuf, int cidx);
   KeyType mask_addr (KeyType addr);
   void    read_mem(char* str, b_tree_node_ptr* root);
-  void    set_random();
+  void    set_tg_seed(unsigned int seed);
+  unsigned int get_tg_seed();
 #ifdef  __cplusplus
 }
 #endif
@@ -20,12 +20,16 @@
 // 
 // ========== Copyright Header End ============================================
 #include "cpx.h"
+#include "bw_lib.h"
+#include "iob_sim.h"
 /*------------------------------------------
   constructor.
 --------------------------------------------*/
+unsigned int cpx::instances = 0;
 cpx::cpx()
 {
   req_sent    = 0;
+  bw_rng_seed(&rng, get_tg_seed(), BW_RNG_STREAM(BW_RNG_STREAM_CPX, instances++));
 
 }
 /*------------------------------------------
@@ -50,7 +54,7 @@ void cpx::xlation(pcx* pkt, char* data)
   //one for request and implement way.
   cpx_pkt[4]  = (*pkt).pkt[3];
   //delay
-  req_wait = random() & 7;
+  req_wait = bw_rng_next(&rng) & 7;
   cpx_wait = req_wait + 1;
   
  }
@@ -79,11 +83,7 @@ int* cpx::get_cpx()
   //case INT_RET :
     cpx_pkt[0] &= 0x17000;
   //print cpx packet
-#ifndef PITON_DPI
-  io_printf((char *)"(%0d)Info: cpx packet from iob ->", tf_gettime());
-#else // ifndef PITON_DPI
-  io_printf((char *)"Info: cpx packet from iob ->");
-#endif // ifndef PITON_DPI
+  io_printf((char *)"(%llu)Info: cpx packet from iob ->", iob_sim_time());
   io_printf((char *)"%x", cpx_pkt[0] & 0x1ffff);
   for(idx = 1; idx < 5;idx++)io_printf((char *)"%08x", cpx_pkt[idx]);
   io_printf((char *)"\n");
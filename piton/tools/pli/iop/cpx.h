@@ -26,6 +26,7 @@
 #define _CPX_H_
 #include "global.h"
 #include "pcx.h"
+#include "bw_rng.h"
 #define CPX_SIZE 4
 
 #define INT_RET         0x7
@@ -38,6 +39,8 @@ private:
   char req_sent, req;
   //cpx packet
   int cpx_pkt[5];
+  //private random stream for the delays.
+  bw_rng rng;
   
  //start funcs and variable here
 
@@ -45,6 +48,10 @@ public:
   //constructor
   char cpu_id, thrid;
   int true_id;
+  //number of streams handed out, rewound between batch tests.
+  static unsigned int instances;
+  //iob cycle of the xlation.
+  unsigned long long stamp;
   cpx();
   void  xlation(pcx* pkt, char* data);
   int*  get_cpx();
@@ -0,0 +1,300 @@
+/*
+Copyright (c) 2019 Princeton University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Princeton University nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY PRINCETON UNIVERSITY "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL PRINCETON UNIVERSITY BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/*------------------------------------------
+ev_compare.cc
+checks the diag.ev tokenizer of iob.cc against
+the parser it replaced (fgets, replace, copy,
+rmhexa and getEight, kept here as it was).
+
+  ev_compare FILE...
+
+a FILE ending in .s or .S is a diag source, its
+!$EV lines are taken as midas writes them to
+diag.ev, with a made up pc for the expr() midas
+would resolve. every intp() event of both parsers is
+compared field by field, the exit code is 1 on
+a difference. ev_compare.sh runs it over the
+diags of verif/diag.
+
+with three arguments to intp() the old parser
+read the source and count from before the start
+of its line buffer, these events are counted as
+undefined and only their first fields compared.
+-------------------------------------------*/
+#include <stdio.h>
+#include <unistd.h>
+#include <vector>
+#include "iob.h"
+#include "iob_sim.h"
+
+//the model asks the simulator for nothing here.
+char* iob_sim_plusargs(const char* name){return (char *) 0;}
+unsigned long long iob_sim_time(){return 0;}
+void iob_sim_finish(){exit(2);}
+
+typedef struct old_event{
+  KeyType key;
+  int     kind, thrid, type, vec, src, wait;
+  int     undefined;
+} old_event;
+
+/*------------------------------------------
+the old parser, rmSpace() is the one of
+bw_lib.c, -1 at the end of the line.
+-------------------------------------------*/
+static void old_replace(char* str)
+{
+  int i;
+  for(i = 0; i < (int)strlen(str);i++){
+    if(
+       str[i] == '(' ||
+       str[i] == ')' ||
+       str[i] == '-' ||
+       str[i] == '>' ||
+       str[i] == '"' ||
+       str[i] == ',')str[i] = ' ';
+  }
+}
+
+//the old copy() read buf[-1] on; an empty field stands for that here.
+static int old_copy(char* buf, int* idx,  char* cbuf)
+{
+  int ind = 0;
+  if(*idx < 0){
+    cbuf[0] = '\0';
+    return 1;
+  }
+  while((buf[*idx] != '\0') &&
+	(buf[*idx] != '\n') &&
+	(buf[*idx] != ' ')){
+    cbuf[ind++] = buf[*idx];
+    (*idx)++;
+  }
+  cbuf[ind] = '\0';
+  return 0;
+}
+
+static KeyType old_getEight(char *buf)
+{
+  int  i;
+  KeyType key = 0;
+
+  for(i = 0;  buf[i] != '\0';i++){
+    key <<= 4;
+    key  |= buf[i] > '9' ? ((buf[i] & 0xf) + 9) : buf[i] & 0xf;
+  }
+  return key;
+}
+
+static void old_rmhexa(char* buf){
+  int i, j;
+
+  for(i = 0;i < (int)strlen(buf);i++){
+    if(buf[i] == 'h' || buf[i] == 'x')break;
+  }
+  j  = 0;
+  for(i = i+1;i < (int)strlen(buf);i++){
+    buf[j++] = buf[i];
+  }
+  buf[j] = '\0';
+}
+
+static void old_get_event(const char* str, std::vector<old_event>& events)
+{
+  FILE *fp;
+  char  buf [BUFFER];
+  char  cbuf[BUFFER];
+  int   idx, undefined;
+  old_event ev;
+
+  if((fp = fopen(str, "r")) == 0)return;
+  while(fgets(buf, BUFFER, fp)){
+    idx = rmSpace(buf, 0, BUFFER);
+    old_replace(buf);
+    if(strncmp(buf, "trig_pc_d ", 10))continue;
+    undefined = 0;
+    idx = rmSpace(buf, 10, BUFFER);
+    undefined |= old_copy(buf, &idx, cbuf);ev.kind = atoi(cbuf);
+    idx = rmSpace(buf, idx, BUFFER);
+    undefined |= old_copy(buf, &idx, cbuf);
+    old_rmhexa(cbuf);
+    ev.key = old_getEight(cbuf);
+    idx = rmSpace(buf, idx, BUFFER);
+    undefined |= old_copy(buf, &idx, cbuf);
+    if(strncmp(cbuf, "intp", 4))continue;
+    idx = rmSpace(buf, idx, BUFFER);
+    undefined |= old_copy(buf, &idx, cbuf);
+    ev.thrid = (int)old_getEight(cbuf);
+    idx = rmSpace(buf, idx, BUFFER);
+    undefined |= old_copy(buf, &idx, cbuf);
+    ev.type = (int)old_getEight(cbuf);
+    idx = rmSpace(buf, idx, BUFFER);
+    undefined |= old_copy(buf, &idx, cbuf);
+    ev.vec  = (int)old_getEight(cbuf);
+    ev.wait = 0;
+    ev.src  = 33;
+    ev.undefined = undefined;
+    if(idx >= 0 && idx < (int)strlen(buf)){
+      idx = rmSpace(buf, idx, BUFFER);
+      ev.undefined |= old_copy(buf, &idx, cbuf);
+      ev.src = (int)old_getEight(cbuf);
+      idx = rmSpace(buf, idx, BUFFER);
+      ev.undefined |= old_copy(buf, &idx, cbuf);
+      ev.wait = (int)old_getEight(cbuf);
+    }
+    ev.wait = ev.wait > 0 ? ev.wait : 1;
+    events.push_back(ev);
+  }
+  fclose(fp);
+}
+
+/*------------------------------------------
+the !$EV lines of a diag source, as diag.ev.
+every expr(...) becomes a pc of its own.
+-------------------------------------------*/
+static int extract_ev(const char* diag, char* tmp)
+{
+  FILE *in, *out;
+  char  buf[BUFFER];
+  int   fd, line = 0;
+
+  strcpy(tmp, "/tmp/ev_compare.XXXXXX");
+  if((fd = mkstemp(tmp)) < 0)return -1;
+  if((in = fopen(diag, "r")) == 0 || (out = fdopen(fd, "w")) == 0){
+    if(in)fclose(in);
+    close(fd);
+    unlink(tmp);
+    return -1;
+  }
+  while(fgets(buf, BUFFER, in)){
+    char *ev = strstr(buf, "$EV "), *expr, *end;
+    int   depth;
+
+    line++;
+    if(!ev || (ev != buf && ev[-1] != '!'))continue;
+    ev += 4;
+    while((expr = strstr(ev, "expr(")) != 0){
+      for(end = expr + 4, depth = 0; *end; end++){
+        if(*end == '(')depth++;
+        if(*end == ')' && --depth == 0)break;
+      }
+      if(*end == '\0')break;
+      fwrite(ev, 1, expr - ev, out);
+      fprintf(out, "64'h%llx", 0x20000000ULL + ((unsigned long long)line << 4));
+      ev = end + 1;
+    }
+    fputs(ev, out);
+  }
+  fclose(in);
+  fclose(out);
+  return 0;
+}
+
+/*------------------------------------------
+compare the events of one file, 0 when
+they are the same.
+-------------------------------------------*/
+static int compare(const char* name, const char* file, int* total, int* undefined)
+{
+  std::vector<old_event> old_events;
+  std::map<KeyType, size_t> seen;
+  std::map<KeyType, std::list<event_record*> >::const_iterator found;
+  int diff = 0, num = 0;
+  iob model;
+
+  old_get_event(file, old_events);
+  //prints an Info: line per event, not wanted here
+  fflush(stdout);
+  int saved = dup(1);
+  if(freopen("/dev/null", "w", stdout) == 0){
+    close(saved);
+    return 1;
+  }
+  model.get_event((char *)file);
+  fflush(stdout);
+  dup2(saved, 1);
+  close(saved);
+  clearerr(stdout);
+
+  for(found = model.events().begin(); found != model.events().end(); found++)
+    num += found->second.size();
+  if(num != (int)old_events.size()){
+    printf("%s: %d events, the old parser %d\n", name, num, (int)old_events.size());
+    diff = 1;
+  }
+  for(size_t i = 0; i < old_events.size(); i++){
+    const old_event& ev = old_events[i];
+    found = model.events().find(ev.key);
+    size_t n = seen[ev.key]++;
+    if(found == model.events().end() || n >= found->second.size()){
+      printf("%s: event %d at pc %llx missing\n", name, (int)i + 1, ev.key);
+      diff = 1;
+      continue;
+    }
+    std::list<event_record*>::const_iterator iter = found->second.begin();
+    std::advance(iter, n);
+    const event_record* rec = *iter;
+    int same = rec->kind == ev.kind && rec->thrid == ev.thrid &&
+               rec->type == ev.type && rec->vec == ev.vec;
+    if(!ev.undefined)same = same && rec->src == ev.src && rec->wait == ev.wait;
+    else (*undefined)++;
+    if(!same){
+      printf("%s: event %d at pc %llx: kind %d/%d thread %d/%d type %d/%d vec %d/%d src %d/%d count %d/%d\n",
+             name, (int)i + 1, ev.key, rec->kind, ev.kind, rec->thrid, ev.thrid, rec->type, ev.type,
+             rec->vec, ev.vec, rec->src, ev.src, rec->wait, ev.wait);
+      diff = 1;
+    }
+  }
+  *total += old_events.size();
+  return diff;
+}
+
+int main(int argc, char** argv)
+{
+  int  total = 0, undefined = 0, files = 0, failed = 0;
+  char tmp[64];
+
+  if(argc < 2){
+    fprintf(stderr, "usage: ev_compare FILE...\n");
+    return 2;
+  }
+  for(int i = 1; i < argc; i++){
+    size_t len = strlen(argv[i]);
+    int diag = len > 2 && argv[i][len - 2] == '.' && (argv[i][len - 1] == 's' || argv[i][len - 1] == 'S');
+    if(diag && extract_ev(argv[i], tmp)){
+      printf("%s: can not read\n", argv[i]);
+      failed++;
+      continue;
+    }
+    failed += compare(argv[i], diag ? tmp : argv[i], &total, &undefined);
+    if(diag)unlink(tmp);
+    files++;
+  }
+  printf("ev_compare: %d files, %d events, %d of them with an undefined old source/count, %d files differ\n",
+         files, total, undefined, failed);
+  return failed ? 1 : 0;
+}
@@ -20,16 +20,29 @@
 // 
 // ========== Copyright Header End ============================================
 #include "iob.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 /*-----------------------------------------------------------------------------
   constructor.
 -----------------------------------------------------------------------------*/
 int iob::manual_init(char* ev)
 {
-  
+  int period;
+
   //set qsel to zero, it means avaiable 2.
   for(idx = 0; idx < 8; idx++)Qsel[idx] = 0;
+  pcx_streams = pcx::instances;
+  cpx_streams = cpx::instances;
+  //statistics, +iob_stats_period=N for periodic snapshots,
+  //+iob_stats_file=NAME for the names of the files.
+  //the period is converted first, the next lookup overwrites pargs under verilator.
+  pargs  = iob_sim_plusargs("iob_stats_period=");
+  period = pargs ? atoi(pargs) : 0;
+  stats.init(period, iob_sim_plusargs("iob_stats_file="));
   //get iob event from event file.
-  get_event(ev);
+  if(get_event(ev))return -1;
   //generate boot cpx packet.
   boot();
   grant   = 0;//cpx grant
@@ -39,6 +52,39 @@ int iob::manual_init(char* ev)
   next_req= 0;//reset flag for request.
   return 0;
 }
+/*-----------------------------------------------------------------------------
+  free all packets of a list.
+-----------------------------------------------------------------------------*/
+template <class T>
+static void free_list(std::list<T*>& lst)
+{
+  while(!lst.empty()){
+    delete lst.front();
+    lst.pop_front();
+  }
+}
+/*-----------------------------------------------------------------------------
+  end of one test: write the statistics, free the pc events and packets.
+  The random streams are rewound, so the next test gets the same delays
+  it would get in a simulator of its own.
+-----------------------------------------------------------------------------*/
+void iob::clear()
+{
+  std::map<KeyType, std::list<event_record*> >::iterator found;
+  std::list<event_record*>::iterator iter;
+
+  stats.finish();
+  for(found = inst_event.begin(); found != inst_event.end(); found++)
+    for(iter = found->second.begin(); iter != found->second.end(); iter++)
+      delete *iter;
+  inst_event.clear();
+  free_list(pcx_list);
+  free_list(pcx_heap);
+  free_list(cpx_list);
+  free_list(cpx_heap);
+  pcx::instances = pcx_streams;
+  cpx::instances = cpx_streams;
+}
 /*-----------------------------------------------------------------------------
   deceide the bbot thread to start cmp.
 -----------------------------------------------------------------------------*/
@@ -46,11 +92,7 @@ void iob::boot()
 {
   char  *pargs;
   int mask, i;
-  #ifndef PITON_DPI
-  pargs = mc_scan_plusargs ((char *)"bootthread=");
-  #else
-  pargs = (char *) 0;
-  #endif
+  pargs = iob_sim_plusargs("bootthread=");
   if(pargs != (char *) 0){
     mask = atoi(pargs);
   }
@@ -77,79 +119,87 @@ void iob::boot()
   (*p_pkt).pkt[3] |= ((i & 0x7f) << 18);
   (*p_pkt).pkt[3] |= ((i & 0x3) << 10);
   (*p_pkt).pkt[3] |= 1;
-  pcx_list.push_back(p_pkt);
+  queue_pcx(p_pkt);
 }
 /*-----------------------------------------------------------------------------
   This routine only extract the pc event from diag.ev.
+  The file is mapped and every line is tokenized in place, the events are
+  pushed straight onto the per-pc list of inst_event.
 
  $EV trig_pc_d(1, virtal)->intp(1 ,2, 3, source, number)
 -----------------------------------------------------------------------------*/
-void iob::get_event(char* str)
+int iob::get_event(char* str)
 {
-  FILE *fp;//file pointer
-  char  buf [BUFFER];
-  char  cbuf[BUFFER];//temp variavle for intermiate data
-  int kind;
- 
-  if((fp = fopen(str, "r")) == 0){
+  int fd;
+  struct stat st;
+  const char *map, *cur, *eol, *end;
+
+  if((fd = open(str, O_RDONLY)) < 0){
     io_printf((char *)"Error:  can not open the event file %s for reading\n", str);
-    #ifndef PITON_DPI
-    tf_dofinish();
-    #else // ifndef PITON_DPI
-    exit(1);
-    #endif // ifndef PITON_DPI
+    iob_sim_finish();
+    return -1;
   }
-  while(fgets(buf, BUFFER, fp)){
-    idx = rmSpace(buf, 0, BUFFER);    
-    replace(buf);
-    if(strncmp(buf, "trig_pc_d ", 10))continue; 
-    idx = rmSpace(buf, 10, BUFFER);   
-    copy(buf, &idx, cbuf);kind = atoi(cbuf);//which
-    idx = rmSpace(buf, idx, BUFFER);   
-    copy(buf, &idx, cbuf);//pc value
-    rmhexa(cbuf);
-    key = getEight(cbuf);
-    idx = rmSpace(buf, idx, BUFFER);   
-    copy(buf, &idx, cbuf);
-    if(strncmp(cbuf, "intp", 4))continue;//here only handle interrupt
-    one_event = new event_record;
-    //get thread id
-    idx = rmSpace(buf, idx, BUFFER);   
-    copy(buf, &idx, cbuf);
-    one_event->thrid = (int)getEight(cbuf);
-    one_event->cpu_id= (one_event->thrid >> 2) & 7;//cpu_id(3bits)
-    one_event->true_id = (one_event->thrid >> 1);
-    idx = rmSpace(buf, idx, BUFFER);
-    copy(buf, &idx, cbuf); 
-    one_event->type = (int)getEight(cbuf);//interrupt type
-    idx = rmSpace(buf, idx, BUFFER);   
-    copy(buf, &idx, cbuf);
-    one_event->vec  = (int)getEight(cbuf);//vector
-    one_event->wait = 0;
-    one_event->src  = 33;//any thread
-    //additional argments
-    if(idx < strlen(buf)){
-      idx = rmSpace(buf, idx, BUFFER);   
-      copy(buf, &idx, cbuf);
-      one_event->src = (int)getEight(cbuf);//get which thread looking for.
-      idx = rmSpace(buf, idx, BUFFER);   
-      copy(buf, &idx, cbuf);
-      one_event->wait = (int)getEight(cbuf);//get which thread looking for.
-    }
-    one_event->wait       = one_event->wait > 0 ? one_event->wait : 1;
-    one_event->kind       = kind;
-    //save event on the event tree.
-    if(inst_event.count(key) > 0) {
-      event_list = &inst_event.at(key);
-      event_list->push_back(one_event);
-    }else{//push event on the list
-      event_list = new std::list<event_record*>;
-      event_list->push_back(one_event);
-      inst_event[key] = (*event_list);
-    }
-    io_printf((char *)"Info: intp(%llx) thread(%d) number(%d)\n", key, one_event->thrid, one_event->wait);
+  if(fstat(fd, &st) < 0 || st.st_size == 0){
+    close(fd);
+    return 0;
+  }
+  map = (const char*)mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if(map == (const char*)MAP_FAILED){
+    io_printf((char *)"Error:  can not map the event file %s\n", str);
+    close(fd);
+    iob_sim_finish();
+    return -1;
   }
-  fclose(fp); 
+  end = map + st.st_size;
+  for(cur = map; cur < end; cur = eol + 1){
+    eol = (const char*)memchr(cur, '\n', end - cur);
+    if(eol == 0)eol = end;
+    parse_event(cur, eol);
+  }
+  munmap((void*)map, st.st_size);
+  close(fd);
+  return 0;
+}
+/*-----------------------------------------------------------------------------
+  parse one line of diag.ev, [line, eol).
+  tokens are separated by the event syntax characters, nothing is copied.
+-----------------------------------------------------------------------------*/
+void iob::parse_event(const char* line, const char* eol)
+{
+  ev_token tok;
+  int kind;
+
+  if(!next_token(&line, eol, &tok))return;
+  if(tok.len != 9 || strncmp(tok.ptr, "trig_pc_d", 9))return;
+  if(!next_token(&line, eol, &tok))return;
+  kind = tok_dec(&tok);//which
+  if(!next_token(&line, eol, &tok))return;
+  key  = tok_hex(&tok, 1);//pc value
+  if(!next_token(&line, eol, &tok))return;
+  if(tok.len < 4 || strncmp(tok.ptr, "intp", 4))return;//here only handle interrupt
+  one_event = new event_record;
+  //get thread id
+  next_token(&line, eol, &tok);
+  one_event->thrid = (int)tok_hex(&tok, 0);
+  one_event->cpu_id= (one_event->thrid >> 2) & 7;//cpu_id(3bits)
+  one_event->true_id = (one_event->thrid >> 1);
+  next_token(&line, eol, &tok);
+  one_event->type = (int)tok_hex(&tok, 0);//interrupt type
+  next_token(&line, eol, &tok);
+  one_event->vec  = (int)tok_hex(&tok, 0);//vector
+  one_event->wait = 0;
+  one_event->src  = 33;//any thread
+  //additional argments
+  if(next_token(&line, eol, &tok)){
+    one_event->src = (int)tok_hex(&tok, 0);//get which thread looking for.
+    next_token(&line, eol, &tok);
+    one_event->wait = (int)tok_hex(&tok, 0);//get which thread looking for.
+  }
+  one_event->wait       = one_event->wait > 0 ? one_event->wait : 1;
+  one_event->kind       = kind;
+  //save event on the event tree.
+  inst_event[key].push_back(one_event);
+  io_printf((char *)"Info: intp(%llx) thread(%d) number(%d)\n", key, one_event->thrid, one_event->wait);
 }
 /*-----------------------------------------------------------------------------
 generate event.
@@ -180,14 +230,9 @@ void iob::gen_event()
         p_pkt->pkt[3] |= (one_event->thrid & 3) << 8;
         p_pkt->pkt[3] |= one_event->vec;
         p_pkt->wait   = 3;
-      pcx_list.push_back(p_pkt);
-      #ifndef PITON_DPI
-      io_printf((char *)"(%0d)Info:generating interrupt pcx packet thread(%d) many(%d)\n",
-		tf_gettime(), p_pkt->thrid, one_event->wait);
-      #else
-      io_printf((char *)"Info:generating interrupt pcx packet thread(%d) many(%d)\n",
-		p_pkt->thrid, one_event->wait);
-      #endif
+      queue_pcx(p_pkt);
+      io_printf((char *)"(%llu)Info:generating interrupt pcx packet thread(%d) many(%d)\n",
+		iob_sim_time(), p_pkt->thrid, one_event->wait);
       one_event->wait--;
       /* if(one_event->wait == 0){
 	delete one_event;
@@ -199,37 +244,29 @@ void iob::gen_event()
   }
 }
 /*-----------------------------------------------------------------------------
- do pc event for 8 cores.
-layout:
-1). inst_done 
-2). phyical pc
+  queue an interrupt pcx packet.
 -----------------------------------------------------------------------------*/
-#ifndef PITON_DPI
-void iob::trig_pc_event()
+void iob::queue_pcx(pcx* pkt)
 {
-  for(idx = PC_EVENT; idx < PC_EVENT + 8; idx += 2){
-    if(tf_getp(idx)){//check instruction done
-      low   = tf_getlongp(&high, idx+1);
-      pc    = ((((KeyType) (high & 0xffff)) << 32) | low);
-      if(inst_event.count(pc) > 0) {
-        event_list = &inst_event.at(pc);
-	io_printf((char *)"(%0d)Info:generate interrupt events for this pc(%llx)\n", tf_gettime(), pc);
-	gen_event();
-      }
-    }
-  }
+  pkt->stamp = stats.cycles;
+  pcx_list.push_back(pkt);
+  stats.enqueue();
 }
-#else // ifndef PITON_DPI
+/*-----------------------------------------------------------------------------
+ pc event, called by the adapter for every instruction done of a core.
+-----------------------------------------------------------------------------*/
 void iob::trig_pc_event(unsigned long long thread_pc)
 {
-    pc = thread_pc;
-    if(inst_event.count(pc) > 0) {
-        event_list = &inst_event.at(pc);
-	io_printf((char *)"Info:generate interrupt events for this pc(%llx)\n", pc);
-	gen_event();
-    }
+  std::map<KeyType, std::list<event_record*> >::iterator found;
+
+  pc    = thread_pc;
+  found = inst_event.find(pc);
+  if(found != inst_event.end()){
+    event_list = &found->second;
+    io_printf((char *)"(%llu)Info:generate interrupt events for this pc(%llx)\n", iob_sim_time(), pc);
+    gen_event();
+  }
 }
-#endif // ifndef PITON_DPI
 /*-----------------------------------------------------------------------------
   process pcx packet.
   -----------------------------------------------------------------------------*/
@@ -249,6 +286,9 @@ void iob::handle_pcx()
     }
     if(data)(*c_pkt).xlation(p_pkt, data->data);
     else (*c_pkt).xlation(p_pkt, (char*)0);
+    stats.pcx_xlated++;
+    stats.pcx_wait.add(stats.cycles - (*p_pkt).stamp);
+    (*c_pkt).stamp = stats.cycles;
     cpx_list.push_back(c_pkt);//push cpx on list
     pcx_heap.push_back(p_pkt);//keep it on heap.
   }
@@ -257,80 +297,39 @@ void iob::handle_pcx()
   send cpx packet.
   1). pkt_vld, send the valid cpx packet.
   2). next_cpx = 1, reset the valid bit.
+  return 1 when the cpx output changed and has to be driven again.
 -----------------------------------------------------------------------------*/
-#ifndef PITON_DPI
-void iob::drive_cpx(int loc)
-{
-#else // ifndef PITON_DPI
 int iob::drive_cpx()
 {
-#endif // ifndef PITON_DPI
-#ifdef USE_ACC
-  s_setval_delay delay_s;
-  s_setval_value value_s;
-  handle tmphandle;
-  delay_s.model = accNoDelay;
-  char* outdata = new char[150];
-  char* tmpdata = new char[33];
-#endif
-
-  if(!((pkt_vld == 0) && (next_cpx == 0))){//there is data to be sent.
-    if(pkt_vld == 0)next_cpx = 0;
-    else{
-      c_pkt              = cpx_list.front();//remove a packet from the top of stack
-      cpx_list.pop_front();
-      ptr                = (*c_pkt).get_cpx();  
-      pkt_vld            = 0;//clear wait for the next request.
-      next_cpx           = 1;
-      cpx_heap.push_back(c_pkt);//free memory
-    }
-
-#ifndef PITON_DPI
-#ifdef USE_ACC
-    sprintf(outdata,"%x", next_cpx ? (ptr[0] & 0x1ffff) : 0);
-    for(idx = 1; idx < 5;idx++) {
-	sprintf(tmpdata,"%0.8x", next_cpx ? ptr[idx] : 0);
-	strcat(outdata,tmpdata);
-    }
-    acc_initialize();
-    tmphandle = acc_handle_tfarg(loc);
-    value_s.format = accHexStrVal;
-    value_s.value.str = outdata;
-    acc_set_value(tmphandle, &value_s, &delay_s);
-
-#else // ifdef USE_ACC
-    tf_nodeinfo(loc, &node_info);
-    idx = 0;
-    for(groups = node_info.node_ngroups -1 ; groups >= 0; groups--){
-      node_info.node_value.vecval_p[groups].avalbits = next_cpx ? ptr[idx++] : 0;
-      node_info.node_value.vecval_p[groups].bvalbits = 0;
-    }
-    tf_propagatep(loc);
-#endif // ifdef USE_ACC
-#endif // ifndef PITON_DPI
+  if((pkt_vld == 0) && (next_cpx == 0))return 0;//nothing to be sent.
+  if(pkt_vld == 0)next_cpx = 0;
+  else{
+    c_pkt              = cpx_list.front();//remove a packet from the top of stack
+    cpx_list.pop_front();
+    memcpy(cur_pkt, (*c_pkt).get_cpx(), sizeof(cur_pkt));
+    pkt_vld            = 0;//clear wait for the next request.
+    next_cpx           = 1;
+    stats.retire();
+    stats.cpx_grant.add(stats.cycles - (*c_pkt).stamp);
+    cpx_heap.push_back(c_pkt);//free memory
   }
-#ifdef PITON_DPI
-  return next_cpx;
-#endif // ifndef PITON_DPI
+  return 1;
 }
-
-#ifdef PITON_DPI
-int iob::get_cpx_word(int index)
+/*-----------------------------------------------------------------------------
+  current cpx packet, CPX_WORDS words with word 0 on top. zero when idle.
+-----------------------------------------------------------------------------*/
+const int* iob::get_cpx_pkt()
 {
-    return ptr[index];
+  static const int idle_pkt[CPX_WORDS] = {0, 0, 0, 0, 0};
+  return next_cpx ? cur_pkt : idle_pkt;
 }
-#endif // ifdef PITON_DPI
 /*-----------------------------------------------------------------------------
  drive the valid. At the next cycle, reset request.
 -----------------------------------------------------------------------------*/
 void iob::drive_req()
 {
   if(next_req){
-    #ifndef PITON_DPI
-    io_printf((char *)"Info(%0d): cpx request %x\n", tf_gettime(), req & 0xff);
-    #else // ifndef PITON_DPI
-    io_printf((char *)"Info: cpx request %x\n", req & 0xff);
-    #endif // ifndef PITON_DPI
+    io_printf((char *)"Info(%llu): cpx request %x\n", iob_sim_time(), req & 0xff);
     grant = req; // Was used to push data in verilog
     next_req = req ? 1 : 0;
     req      = 0;
@@ -346,23 +345,23 @@ void iob::handle_cpx()
   if((*c_pkt).get_req_wait() && (Qsel[(*c_pkt).cpu_id] != 2)){//send request
     req     = (*c_pkt).get_req();
     next_req= 1;   
-    #ifndef PITON_DPI
-    io_printf((char *)"Info(%d): Qsel value(%d)\n", tf_gettime(), Qsel[(*c_pkt).cpu_id]);
-    #else // ifndef PITON_DPI
-    io_printf((char *)"Info: Qsel value(%d)\n", Qsel[(*c_pkt).cpu_id]);
-    #endif // ifndef PITON_DPI
+    io_printf((char *)"Info(%llu): Qsel value(%d)\n", iob_sim_time(), Qsel[(*c_pkt).cpu_id]);
     Qsel[(*c_pkt).cpu_id]++;
+    stats.cpx_req++;
   }
+  else if((*c_pkt).get_req_wait())stats.qsel_stall[(*c_pkt).cpu_id & 7]++;
   if((*c_pkt).get_cpx_wait())pkt_vld = 1;
 }
 /*-----------------------------------------------------------------------------
  This is the main interface routine between cmp and iob.
+ the pc events of the cycle are reported before through trig_pc_event.
 1). check pcx packet.
 2). check grant signal
 3). drive cpx packet.
 -----------------------------------------------------------------------------*/
 void iob::do_iob()
 {
+  stats.tick();
   //drive signals.
   //cpx grant
   if(grant != 0){
@@ -371,75 +370,182 @@ void iob::do_iob()
       grant >>= 1;
     }
   }
-  #ifndef PITON_DPI
-  trig_pc_event();//check pc event
-  #endif // ifndef PITON_DPI
   if(pcx_list.empty() == 0)handle_pcx();
   if(cpx_list.empty() == 0)handle_cpx();
 }
 
-// Below is from strclass.cc / strclass.h which became unnecessary
+/*-----------------------------------------------------------------------------
+ checkpoint helpers. pcx and cpx hold no pointers, they are copied as is.
+-----------------------------------------------------------------------------*/
+template <class T>
+static int save_list(FILE* fp, std::list<T*>& lst)
+{
+  typename std::list<T*>::iterator iter;
+  int num = lst.size();
+
+  if(fwrite(&num, sizeof(num), 1, fp) != 1)return -1;
+  for(iter = lst.begin(); iter != lst.end(); iter++)
+    if(fwrite(*iter, sizeof(T), 1, fp) != 1)return -1;
+  return 0;
+}
+
+/*-----------------------------------------------------------------------------
+ the saved packets keep their streams, the constructor must not hand out
+ a new one: the counter is put back after each object.
+-----------------------------------------------------------------------------*/
+template <class T>
+static int restore_list(FILE* fp, std::list<T*>& lst)
+{
+  T*  obj;
+  int num;
+  unsigned int streams = T::instances;
+
+  free_list(lst);
+  if(fread(&num, sizeof(num), 1, fp) != 1)return -1;
+  while(num-- > 0){
+    obj = new T;
+    T::instances = streams;
+    if(fread(obj, sizeof(T), 1, fp) != 1){
+      delete obj;
+      return -1;
+    }
+    lst.push_back(obj);
+  }
+  return 0;
+}
+/*-----------------------------------------------------------------------------
+ save the state the iob needs to continue: request/grant flags, qsel, the
+ packet on the bus, the stream counters of pcx and cpx, queued and free
+ packets with their random streams and the remaining count of every pc
+ event, -1 instead of the counts when events is 0.
+-----------------------------------------------------------------------------*/
+int iob::save(FILE* fp, int events)
+{
+  std::map<KeyType, std::list<event_record*> >::iterator found;
+  std::list<event_record*>::iterator iter;
+  int num = 0;
+
+  if(fwrite(&grant,    sizeof(grant),    1, fp) != 1 ||
+     fwrite(&req,      sizeof(req),      1, fp) != 1 ||
+     fwrite(&thrid,    sizeof(thrid),    1, fp) != 1 ||
+     fwrite(&pkt_vld,  sizeof(pkt_vld),  1, fp) != 1 ||
+     fwrite(&next_req, sizeof(next_req), 1, fp) != 1 ||
+     fwrite(&next_cpx, sizeof(next_cpx), 1, fp) != 1 ||
+     fwrite(Qsel,      sizeof(Qsel),     1, fp) != 1 ||
+     fwrite(cur_pkt,   sizeof(cur_pkt),  1, fp) != 1 ||
+     fwrite(&stats.cycles,  sizeof(stats.cycles),  1, fp) != 1 ||
+     fwrite(&pcx::instances, sizeof(pcx::instances), 1, fp) != 1 ||
+     fwrite(&cpx::instances, sizeof(cpx::instances), 1, fp) != 1)return -1;
+  if(save_list(fp, pcx_list) || save_list(fp, pcx_heap) ||
+     save_list(fp, cpx_list) || save_list(fp, cpx_heap))return -1;
+
+  if(events == 0){
+    num = -1;
+    fwrite(&num, sizeof(num), 1, fp);
+    return ferror(fp) ? -1 : 0;
+  }
+  for(found = inst_event.begin(); found != inst_event.end(); found++)
+    num += found->second.size();
+  fwrite(&num, sizeof(num), 1, fp);
+  for(found = inst_event.begin(); found != inst_event.end(); found++)
+    for(iter = found->second.begin(); iter != found->second.end(); iter++)
+      fwrite(&(*iter)->wait, sizeof(int), 1, fp);
+  return ferror(fp) ? -1 : 0;
+}
+/*-----------------------------------------------------------------------------
+ restore what save() wrote, diag.ev must have been read before.
+ the event counters are only taken over when the events are the same.
+-----------------------------------------------------------------------------*/
+int iob::restore(FILE* fp)
+{
+  std::map<KeyType, std::list<event_record*> >::iterator found;
+  std::list<event_record*>::iterator iter;
+  int num = 0, saved;
+
+  if(fread(&grant,    sizeof(grant),    1, fp) != 1 ||
+     fread(&req,      sizeof(req),      1, fp) != 1 ||
+     fread(&thrid,    sizeof(thrid),    1, fp) != 1 ||
+     fread(&pkt_vld,  sizeof(pkt_vld),  1, fp) != 1 ||
+     fread(&next_req, sizeof(next_req), 1, fp) != 1 ||
+     fread(&next_cpx, sizeof(next_cpx), 1, fp) != 1 ||
+     fread(Qsel,      sizeof(Qsel),     1, fp) != 1 ||
+     fread(cur_pkt,   sizeof(cur_pkt),  1, fp) != 1 ||
+     fread(&stats.cycles,  sizeof(stats.cycles),  1, fp) != 1 ||
+     fread(&pcx::instances, sizeof(pcx::instances), 1, fp) != 1 ||
+     fread(&cpx::instances, sizeof(cpx::instances), 1, fp) != 1)return -1;
+  if(restore_list(fp, pcx_list) || restore_list(fp, pcx_heap) ||
+     restore_list(fp, cpx_list) || restore_list(fp, cpx_heap))return -1;
+
+  for(found = inst_event.begin(); found != inst_event.end(); found++)
+    num += found->second.size();
+  if(fread(&saved, sizeof(saved), 1, fp) != 1)return -1;
+  //saved without counters, the ones of diag.ev are still untouched.
+  if(saved == -1)return 0;
+  if(saved != num){
+    io_printf((char *)"Warning: checkpoint has %d pc events, diag.ev %d, keeping diag.ev\n",
+              saved, num);
+    return 0;
+  }
+  for(found = inst_event.begin(); found != inst_event.end(); found++)
+    for(iter = found->second.begin(); iter != found->second.end(); iter++)
+      if(fread(&(*iter)->wait, sizeof(int), 1, fp) != 1)return -1;
+  return 0;
+}
+
 /*---------------------------------------
-  replace char with space.
+  separators of the event syntax.
   ----------------------------------------*/
-void iob::replace(char* str)
+static inline int is_ev_sep(char ch)
 {
-  int i;
-  for(i = 0; i < strlen(str);i++){
-    if(
-       str[i] == '(' ||
-       str[i] == ')' ||
-       str[i] == '-' ||
-       str[i] == '>' ||
-       str[i] == '"' ||
-       str[i] == ',')str[i] = ' ';
-  }
+  return ch == ' '  || ch == '\t' || ch == '\r' ||
+         ch == '('  || ch == ')'  || ch == '-'  ||
+         ch == '>'  || ch == '"'  || ch == ',';
 }
 
 /*--------------------------------------
-  convert ascii to hex array.
+  get the next token of [*cur, eol).
+  return 0 and an empty token at the end of line.
   ---------------------------------------*/
-void iob::copy(char* buf, int* idx,  char* cbuf)
+int iob::next_token(const char** cur, const char* eol, ev_token* tok)
 {
-  int ind;
-  ind = 0;
-  while((buf[*idx] != '\0') && 
-	(buf[*idx] != '\n') &&
-	(buf[*idx] != ' ')){
-    cbuf[ind++] = buf[*idx];
-    (*idx)++;
-  }
-  cbuf[ind] = '\0';
+  const char* p = *cur;
+
+  while(p < eol && is_ev_sep(*p))p++;
+  tok->ptr = p;
+  while(p < eol && !is_ev_sep(*p))p++;
+  tok->len = p - tok->ptr;
+  *cur     = p;
+  return tok->len != 0;
 }
 
 /*--------------------------------------
-   check the address symbol that is "@".
-   if symbol there, return address.
-   ---------------------------------------*/
-KeyType iob::getEight(char *buf)
+  convert a hex token, when radix is set
+  everything up to the 'h' or 'x' is skipped.
+  ---------------------------------------*/
+KeyType iob::tok_hex(const ev_token* tok, int radix)
 {
-  int  i;
+  int  i = 0;
   KeyType key = 0;
 
-  for(i = 0;  buf[i] != '\0';i++){
+  if(radix){
+    while(i < tok->len && tok->ptr[i] != 'h' && tok->ptr[i] != 'x')i++;
+    i++;
+  }
+  for(;  i < tok->len;i++){
     key <<= 4;
-    key  |= buf[i] > '9' ? ((buf[i] & 0xf) + 9) : buf[i] & 0xf;
+    key  |= tok->ptr[i] > '9' ? ((tok->ptr[i] & 0xf) + 9) : tok->ptr[i] & 0xf;
   }
   return key;
 }
 
 /*--------------------------------------
-  remove hexa indicator
+  convert a decimal token.
   ----------------------------------------*/
-void iob::rmhexa(char* buf){
-  int i, j;
-  
-  for(i = 0;i < strlen(buf);i++){
-    if(buf[i] == 'h' || buf[i] == 'x')break;
-  }
-  j  = 0;
-  for(i = i+1;i < strlen(buf);i++){
-    buf[j++] = buf[i];
-  }
-  buf[j] = '\0'; 
+int iob::tok_dec(const ev_token* tok)
+{
+  int i, val = 0;
+
+  for(i = 0; i < tok->len && tok->ptr[i] >= '0' && tok->ptr[i] <= '9';i++)
+    val = val * 10 + (tok->ptr[i] - '0');
+  return val;
 }
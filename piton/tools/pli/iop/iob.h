@@ -30,10 +30,18 @@
 #include "pcx.h"
 #include "cpx.h"
 #include "bw_lib.h"
+#include "iob_stats.h"
+#include "iob_sim.h"
 #include <string.h>
 #ifdef __ICARUS__
 #include "icarus-compat.h"
 #endif
+//token of diag.ev, points into the mapped file.
+typedef struct ev_token{
+  const char* ptr;
+  int         len;
+} ev_token;
+
 //do iob operations
 
 class iob {
@@ -55,9 +63,7 @@ private:
   // ccx qsel
   int Qsel[8];
   //index 
-  int groups, idx;
-  //low and high byte for tf_getlongp
-  int low, high; 
+  int idx;
   //event key
   KeyType pc, key;
   //keep pcx packet in the pcx list.
@@ -69,39 +75,48 @@ private:
   //temporary pcx packet.
   pcx pcx_inst, *p_pkt;
   cpx cpx_inst, *c_pkt;
-  //tf variable for cpx packet.
-#ifndef PITON_DPI
-  s_tfnodeinfo node_info;
-#endif // ifndef PITON_DPI
-  int *ptr;
+  //current cpx packet.
+  int cur_pkt[CPX_WORDS];
   //interrupt register
 
+  //throughput and latency counters
+  iob_stats stats;
+  //first random streams of the packets of this test.
+  unsigned int pcx_streams, cpx_streams;
+
   //routines
   void boot();
-  void get_event(char* ev);
   void handle_pcx();  
   void handle_cpx();  
   void gen_event();
-#ifndef PITON_DPI
-  //drive signals, which is less than 32 bits.
-  void trig_pc_event();
-#endif // ifndef PITON_DPI
-  void replace(char* str);
-  void copy(char* buf, int* idx,  char* cbuf);
-  KeyType getEight(char *buf);
-  void rmhexa(char* buf);
+  void queue_pcx(pcx* pkt);
+  //diag.ev tokenizer
+  void parse_event(const char* line, const char* eol);
+  int  next_token(const char** cur, const char* eol, ev_token* tok);
+  KeyType tok_hex(const ev_token* tok, int radix);
+  int  tok_dec(const ev_token* tok);
 public:
   //constructor
   int manual_init(char *ev);
+  //drop the events and queued packets before the next manual_init
+  void clear();
+  //files of the statistics, after fork()
+  void reopen_stats(){stats.reopen();}
   //iob functions
   void do_iob();
-#ifndef PITON_DPI
-  void drive_cpx(int loc);
-#else // ifndef PITON_DPI
-  int drive_cpx();
-  int get_cpx_word(int index);
+  int  drive_cpx();
+  int  cpx_valid(){return next_cpx;}
+  const int* get_cpx_pkt();
+  int  get_cpx_word(int index){return get_cpx_pkt()[index];}
   void trig_pc_event(unsigned long long thread_pc);
-#endif // ifndef PITON_DPI
   void drive_req();
+  //checkpoint of the queues and event counters, without the counters
+  //when events is 0 (state at reset, before any pc event could fire)
+  int  save(FILE* fp, int events = 1);
+  int  restore(FILE* fp);
+  //pc events of diag.ev, manual_init() reads them; ev_compare.cc
+  //reads them alone and looks at them per pc, in the order of the file
+  int  get_event(char* ev);
+  const std::map<KeyType, std::list<event_record*> >& events() const {return inst_event;}
 };
 #endif
@@ -0,0 +1,114 @@
+// Modified by Princeton University on June 9th, 2015
+// ========== Copyright Header Begin ==========================================
+//
+// OpenSPARC T1 Processor File: iob_main.cc
+// Copyright (c) 2006 Sun Microsystems, Inc.  All Rights Reserved.
+// DO NOT ALTER OR REMOVE COPYRIGHT NOTICES.
+//
+// The above named program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public
+// License version 2 as published by the Free Software Foundation.
+//
+// The above named program is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public
+// License along with this work; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// ========== Copyright Header End ============================================
+// DPI-C adapter of the iob and memory model, split from iob_main.cc.
+// The cpx packet is returned as a packed bit vector in one call.
+#ifdef PITON_DPI
+#include <stdio.h>
+#include <stdlib.h>
+#include "global.h"
+#include "bw_lib.h"
+#include "iob_sim.h"
+#include "svdpi.h"
+
+// Routines called by the verilog code.
+extern "C" void init_jbus_model_call(char *str, int oram);
+extern "C" unsigned long long read_64b_call(unsigned long long key_var);
+extern "C" void write_64b_call(unsigned long long key_var, unsigned long long val);
+extern "C" int drive_iob();
+extern "C" int drive_iob_pkt(svBitVecVal* pkt);
+extern "C" int get_cpx_word(int index);
+extern "C" void report_pc(unsigned long long thread_pc);
+
+/*------------------------------------------
+simulator hooks of the model, plusargs and
+time are in iob_sim.cc.
+-------------------------------------------*/
+void iob_sim_finish()
+{
+  exit(1);
+}
+/*------------------------------------------
+initialize all variable to be used in this env.
+str : memory image
+oram: 1 leaves the memory empty for the oram
+      loader, which is PLI only.
+the verilator harness seeds the model itself.
+-------------------------------------------*/
+void init_jbus_model_call(char *str, int oram)
+{
+#ifndef VERILATOR
+  char* seed = iob_sim_plusargs("tg_seed=");
+  if(seed)set_tg_seed(atoi(seed));
+#endif // ifndef VERILATOR
+  iob_model_init(str, (char *)"diag.ev", oram);
+}
+/*------------------------------------------
+handle the cmp clock domain jobs.
+-------------------------------------------*/
+int drive_iob()
+{
+  iob_model_cycle();
+  return iob_model_cpx_valid();
+}
+/*------------------------------------------
+same as drive_iob, the cpx packet (zero when
+not valid) is written to pkt[CPX_WIDTH-1:0].
+-------------------------------------------*/
+int drive_iob_pkt(svBitVecVal* pkt)
+{
+  const int* words;
+  int idx, valid;
+
+  valid = drive_iob();
+  words = iob_model_cpx();
+  for(idx = 0; idx < CPX_WORDS; idx++)pkt[idx] = words[CPX_WORDS - 1 - idx];
+  pkt[CPX_WORDS - 1] &= 0x1ffff;//bits [144:128]
+  return valid;
+}
+
+int get_cpx_word(int index)
+{
+  return iob_model_cpx()[index];
+}
+
+void report_pc(unsigned long long thread_pc)
+{
+  iob_model_pc(thread_pc);
+}
+
+unsigned long long iob_mem_reads = 0;
+unsigned long long iob_mem_writes = 0;
+
+// get 64b of data from memory
+unsigned long long read_64b_call(unsigned long long key_var)
+{
+  iob_mem_reads++;
+  return iob_model_read(key_var);
+}
+
+// put 64b of data to memory
+void write_64b_call(unsigned long long key_var, unsigned long long val)
+{
+  iob_mem_writes++;
+  iob_model_write(key_var, val);
+}
+#endif // ifdef PITON_DPI
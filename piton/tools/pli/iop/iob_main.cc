@@ -37,35 +37,15 @@
 #include "cpx.h"
 #include "pcx.h"
 #include "b_ary.h"
+#include "iob_sim.h"
 
-#ifdef PITON_DPI
-#include "svdpi.h"
-#endif
-
-// Routines called by the verilog code.
-#ifndef PITON_DPI
-extern "C" void iob_cdrive_call();
-extern "C" void init_jbus_model_call();
-
-extern "C" void read_64b_call();
-extern "C" void write_64b_call();
-
-extern "C" void init_oram_call();
-#else // ifndef PITON_DPI
-extern "C" void init_jbus_model_call(char *str, int oram);
-extern "C" unsigned long long read_64b_call(unsigned long long key_var);
-extern "C" void write_64b_call(unsigned long long key_var, unsigned long long val);
-extern "C" int drive_iob();
-extern "C" int get_cpx_word(int index);
-extern "C" void report_pc(unsigned long long thread_pc);
-#endif
+// Simulator independent part of the iob and memory model. The PLI tasks
+// live in iob_pli.cc, the DPI functions in iob_dpi.cc.
 
 //define global variable
 //This memory is common for all devices.
 static b_tree_node_ptr sysMem;//b_try for memory
 static iob iob_inst; //("diag.ev");
-//file used for oram init
-static FILE *oram_fp = NULL;
 
 //define dummy structure for static variable.
 struct static_for_pli{
@@ -76,59 +56,62 @@ static static_for_pli pli_var;
 /*------------------------------------------
 initialize all variable to be used in this env.
 -------------------------------------------*/
-#ifdef PITON_DPI
-void init_jbus_model_call(char *str, int oram) {
-#else // ifndef PITON_DPI
-void init_jbus_model_call(){
-  char  *str;
-  int   oram;
-#endif // ifndef PITON_DPI
+void iob_model_init(char *str, char *ev, int oram)
+{
   int   idx;
-#ifndef PITON_DPI
-  set_random();
-
-  str       = tf_getcstringp(1);  // a get file name.
-  oram      = tf_getp(2); //whether to use oram or not
-#else // ifndef PITON_DPI
-  str       = (char *) "mem.image";
-  oram      = 0;
-#endif // ifndef PITON_DPI
 
-  iob_inst.manual_init((char *)"diag.ev");
+  iob_inst.manual_init(ev);
   sysMem              = b_create();//create
   if (!oram)
           read_mem(str, &sysMem);//read memory
-  for(idx = 0; idx < 32; idx++)pli_var.last_addr[idx] = oram ? -1 : 0;
+  //nothing cached, pli_var.data may point into a freed memory of the last test.
+  for(idx = 0; idx < 32; idx++)pli_var.last_addr[idx] = (KeyType)-1;
+}
+/*------------------------------------------
+release the memory and the iob state of a test.
+-------------------------------------------*/
+void iob_model_done()
+{
+  iob_inst.clear();
+  b_destroy(sysMem);
+  sysMem = 0;
+}
+/*------------------------------------------
+in a child of fork(), after it moved to its
+own directory.
+-------------------------------------------*/
+void iob_model_fork()
+{
+  iob_inst.reopen_stats();
 }
 /*------------------------------------------
 handle the cmp clock domain jobs.
+return 1 when the cpx output has to be driven again.
 -------------------------------------------*/
-#ifndef PITON_DPI
-void iob_cdrive_call()
+int iob_model_cycle()
 {
+  int changed;
+
   iob_inst.do_iob();//do iob operations.
-  iob_inst.drive_cpx(CPX_LOC);
+  changed = iob_inst.drive_cpx();
   iob_inst.drive_req();
+  return changed;
 }
-#else
-int drive_iob()
+
+int iob_model_cpx_valid()
 {
-    iob_inst.do_iob();
-    int cpx_driven = iob_inst.drive_cpx();
-    iob_inst.drive_req();
-    return cpx_driven;
+  return iob_inst.cpx_valid();
 }
 
-int get_cpx_word(int index)
+const int* iob_model_cpx()
 {
-    return iob_inst.get_cpx_word(index);
+  return iob_inst.get_cpx_pkt();
 }
 
-void report_pc(unsigned long long thread_pc)
+void iob_model_pc(unsigned long long pc)
 {
-    iob_inst.trig_pc_event(thread_pc);
+  iob_inst.trig_pc_event(pc);
 }
-#endif
 /*------------------------------------------
 It return 8 junk bytes to caller.
 -------------------------------------------*/
@@ -164,93 +147,28 @@ void write_eight_byte(char* data, KeyType key, unsigned long long val)
 }
 
 // get 64b of data from memory
-#ifdef PITON_DPI
-unsigned long long read_64b_call(unsigned long long key_var)
-#else // ifdef PITON_DPI
-void read_64b_call()
-#endif
+unsigned long long iob_model_read(KeyType key)
 {
-  KeyType key;
-#ifndef PITON_DPI
-  int low, high;
-  low  = tf_getlongp(&high, 1);
-  key   = high;
-  key <<= 32;
-  key  |= (unsigned)low;
-#else // ifndef PITON_DPI
-  key = key_var;
-#endif // ifndef PITON_DPI
   b_tree_atom_ptr data;
   KeyType   mask_addr;
   mask_addr = (((unsigned long long)key & 0x000000ffffffffffULL) >> 6);
 
-  if(pli_var.last_addr[0] == mask_addr){
-      unsigned long long data = get_eight_byte(pli_var.data[0]->data, key);
-    #ifndef PITON_DPI
-      int low, high;
-      low = data & 0xffffffff;
-      high = (data >> 32) & 0xffffffff;
-      tf_putlongp(2, low, high);
-    return;
-    #else // ifndef PITON_DPI
-    return data;
-    #endif // ifndef PITON_DPI
-  }
-  else {
+  if(pli_var.last_addr[0] != mask_addr){
     // trin
     data = b_Find(&sysMem, &mask_addr);
-    if(data){
-      pli_var.data[0]      = data;
-      pli_var.last_addr[0] = mask_addr;
-
-      unsigned long long data = get_eight_byte(pli_var.data[0]->data, key);
-      #ifndef PITON_DPI
-      int low, high;
-      low = data & 0xffffffff;
-      high = (data >> 32) & 0xffffffff;
-      tf_putlongp(2, low, high);
-      return;
-      #else // ifndef PITON_DPI
-      return data;
-      #endif // ifndef PITON_DPI
-    }
-    else{
+    if(data == 0){
       // io_printf("iob_main.cc: cache line not found at address 0x%llx\n", mask_addr << 6);
-      // io_printf("iob_main.cc1: key was 0x%llx\n", key);
-      // io_printf("iob_main.cc1: high was 0x%x\n", high);
-      // io_printf("iob_main.cc1: low was 0x%x\n", low);
-      #ifndef PITON_DPI
-      tf_putlongp(2, 0, 0);
-      return;
-      #else // ifndef PITON_DPI
       return 0;
-      #endif // ifndef PITON_DPI
     }
+    pli_var.data[0]      = data;
+    pli_var.last_addr[0] = mask_addr;
   }
+  return get_eight_byte(pli_var.data[0]->data, key);
 }
 
-// get 64b of data from memory
-#ifdef PITON_DPI
-void write_64b_call(unsigned long long key_var, unsigned long long val)
-#else // ifdef PITON_DPI
-void write_64b_call()
-#endif
+// put 64b of data to memory
+void iob_model_write(KeyType key, unsigned long long val)
 {
-  KeyType key;
-  #ifndef PITON_DPI
-  int low, high;
-  low  = tf_getlongp(&high, 1);
-  key   = high;
-  key <<= 32;
-  key  |= (unsigned)low;
-  unsigned long long val;
-  low  = tf_getlongp(&high, 2);
-  val   = (unsigned)high;
-  val <<= 32;
-  val  |= (unsigned)low;
-  #else // ifndef PITON_DPI
-  key = key_var;
-  #endif // ifndef PITON_DPI
   b_tree_atom_ptr data;
   KeyType   mask_addr;
   mask_addr = (((unsigned long long)key & 0x000000ffffffffffULL) >> 6);
@@ -289,66 +207,190 @@ void write_64b_call()
 }
 
 /*------------------------------------------
-repeatedly call this to get the queue
-pli argument 1 : filename
-pli argument 2 : done (output)
-pli argument 3 : addr (output)
-pli argument 4 : val0 (output)
-pli argument 5 : val1 (output)
-pli argument 6 : val2 (output)
-pli argument 7 : val3 (output)
-pli argument 8 : val4 (output)
-pli argument 9 : val5 (output)
-pli argument 10: val6 (output)
-pli argument 11: val7 (output)
+count the lines of memory in a range, lines
+never loaded or written are not there.
 -------------------------------------------*/
-#ifndef PITON_DPI
-void init_oram_call(){
-  char  *fn;
-  int   idx;
-
-  size_t len = 0;
-  size_t read;
-  char *line = NULL;
-
-  char buf[9][17];
-
-  unsigned long long addr;
-  unsigned long long val[8];
+int iob_model_lines(KeyType key, unsigned long long size)
+{
+  KeyType line, last;
+  int     num = 0;
+
+  if(size == 0)return 0;
+  last = (((unsigned long long)key + size - 1) & 0x000000ffffffffffULL) >> 6;
+  for(line = ((unsigned long long)key & 0x000000ffffffffffULL) >> 6; line <= last; line++){
+    KeyType find = line;
+    if(b_Find(&sysMem, &find))num++;
+  }
+  return num;
+}
 
-  int i;
+//"iobd", the second layout: iob::save() writes the pcx and cpx stream counters.
+#define IOB_CKPT_MAGIC 0x696f6264u
+/*------------------------------------------
+count and write memory lines of the checkpoint.
+-------------------------------------------*/
+static int count_atom(b_tree_atom_ptr atom, void* num)
+{
+  (*(int*)num)++;
+  return 0;
+}
 
+static int save_atom(b_tree_atom_ptr atom, void* fp)
+{
+  return fwrite(&atom->key,  sizeof(atom->key),  1, (FILE*)fp) != 1 ||
+         fwrite(&atom->size, sizeof(atom->size), 1, (FILE*)fp) != 1 ||
+         fwrite(atom->data,  ATOM_DATA_SIZE,     1, (FILE*)fp) != 1;
+}
+/*------------------------------------------
+save memory and iob state into file.
+layout: magic, number of lines, lines, iob.
+-------------------------------------------*/
+int iob_model_save(const char* file)
+{
+  FILE*    fp;
+  unsigned magic = IOB_CKPT_MAGIC;
+  int      num = 0, ret;
 
-  fn = tf_getcstringp(1);  // a get file name.
-  if (oram_fp == NULL)
-          oram_fp = fopen(fn, "r");
+  if((fp = fopen(file, "wb")) == 0){
+    io_printf((char *)"Error: can not write checkpoint %s\n", file);
+    return -1;
+  }
+  b_walk(sysMem, count_atom, &num);
+  fwrite(&magic, sizeof(magic), 1, fp);
+  fwrite(&num, sizeof(num), 1, fp);
+  ret = b_walk(sysMem, save_atom, fp);
+  if(ret == 0)ret = iob_inst.save(fp);
+  if(fclose(fp) || ret){
+    io_printf((char *)"Error: failed writing checkpoint %s\n", file);
+    return -1;
+  }
+  return 0;
+}
+/*------------------------------------------
+replace memory and iob state with the ones
+saved in file.
+-------------------------------------------*/
+int iob_model_restore(const char* file)
+{
+  FILE*           fp;
+  b_tree_atom_ptr atom;
+  unsigned        magic = 0;
+  int             num = 0, ret = 0;
+
+  if((fp = fopen(file, "rb")) == 0){
+    io_printf((char *)"Error: can not read checkpoint %s\n", file);
+    return -1;
+  }
+  if(fread(&magic, sizeof(magic), 1, fp) != 1 || magic != IOB_CKPT_MAGIC ||
+     fread(&num, sizeof(num), 1, fp) != 1){
+    io_printf((char *)"Error: %s is not an iob checkpoint\n", file);
+    fclose(fp);
+    return -1;
+  }
+  b_destroy(sysMem);
+  sysMem = b_create();
+  while(num-- > 0 && ret == 0){
+    atom = (b_tree_atom_ptr)malloc(sizeof(struct b_tree_atom));
+    if(fread(&atom->key,  sizeof(atom->key),  1, fp) != 1 ||
+       fread(&atom->size, sizeof(atom->size), 1, fp) != 1 ||
+       fread(atom->data,  ATOM_DATA_SIZE,     1, fp) != 1){
+      free(atom);
+      ret = -1;
+    }
+    else b_insert(&sysMem, &atom);
+  }
+  //cached line pointers are gone with the old tree.
+  for(int idx = 0; idx < 32; idx++)pli_var.last_addr[idx] = (KeyType)-1;
+  if(ret == 0)ret = iob_inst.restore(fp);
+  fclose(fp);
+  if(ret)io_printf((char *)"Error: checkpoint %s is truncated\n", file);
+  return ret;
+}
+/*------------------------------------------
+save the iob state alone, no memory lines and
+no pc event counters: the state at the end of
+reset, which tests with other memory images
+and diag.ev files can start from.
+-------------------------------------------*/
+int iob_model_save_state(const char* file)
+{
+  FILE*    fp;
+  unsigned magic = IOB_CKPT_MAGIC;
+  int      num = 0, ret;
 
-  if (oram_fp == NULL) {
-          perror("open()");
-          exit(1);
+  if((fp = fopen(file, "wb")) == 0){
+    io_printf((char *)"Error: can not write checkpoint %s\n", file);
+    return -1;
   }
+  fwrite(&magic, sizeof(magic), 1, fp);
+  fwrite(&num, sizeof(num), 1, fp);
+  ret = iob_inst.save(fp, 0);
+  if(fclose(fp) || ret){
+    io_printf((char *)"Error: failed writing checkpoint %s\n", file);
+    return -1;
+  }
+  return 0;
+}
+/*------------------------------------------
+take over the iob state of a checkpoint of
+iob_model_save_state(), the memory and the
+events iob_model_init loaded stay.
+-------------------------------------------*/
+int iob_model_restore_state(const char* file)
+{
+  FILE*    fp;
+  unsigned magic = 0;
+  int      num = -1, ret;
 
-  read = getline(&line, &len, oram_fp);
+  if((fp = fopen(file, "rb")) == 0){
+    io_printf((char *)"Error: can not read checkpoint %s\n", file);
+    return -1;
+  }
+  if(fread(&magic, sizeof(magic), 1, fp) != 1 || magic != IOB_CKPT_MAGIC ||
+     fread(&num, sizeof(num), 1, fp) != 1 || num != 0){
+    io_printf((char *)"Error: %s is not an iob state checkpoint\n", file);
+    fclose(fp);
+    return -1;
+  }
+  ret = iob_inst.restore(fp);
+  fclose(fp);
+  if(ret)io_printf((char *)"Error: checkpoint %s is truncated\n", file);
+  return ret;
+}
+/*------------------------------------------
+overlay one line of a loaded image on the
+memory, lines already there are replaced.
+-------------------------------------------*/
+static int patch_atom(b_tree_atom_ptr atom, void* arg)
+{
+  b_tree_atom_ptr data = b_Find(&sysMem, &atom->key);
+  if(data){
+    memcpy(data, atom, sizeof(struct b_tree_atom));
+    return 0;
+  }
+  data = (b_tree_atom_ptr)malloc(sizeof(struct b_tree_atom));
+  memcpy(data, atom, sizeof(struct b_tree_atom));
+  b_insert(&sysMem, &data);
+  return 0;
+}
+/*------------------------------------------
+patch a memory image into the running memory,
+used to load a workload after boot.
+-------------------------------------------*/
+int iob_model_load(char* file)
+{
+  b_tree_node_ptr image;
+  FILE*           fp;
 
-  if (read == -1) {
-          tf_putp(2, 1); //done = 1
-  } else {
-          tf_putp(2, 0); //done = 0
-          sscanf(line, "%s %s %s %s %s %s %s %s %s\n",
-                 (char *)(&buf[0]), (char *)(&buf[1]),
-                 (char *)(&buf[2]), (char *)(&buf[3]),
-                 (char *)(&buf[4]), (char *)(&buf[5]),
-                 (char *)(&buf[6]), (char *)(&buf[7]),
-                 (char *)(&buf[8]));
-          addr = strtoul(buf[0], NULL, 16);
-          //io_printf("oram init. addr: %x\n", addr);
-          tf_putlongp(3, addr & 0xffffffff, (addr >> 32) & 0xffffffff);
-          for (i = 1; i < 9; i++)
-                  val[i-1] = strtoul(buf[i], NULL, 16);
-          for (i = 4; i < 4 + 8; i++)
-                  tf_putlongp(i, val[i-4] & 0xffffffff,
-                              (val[i-4] >> 32) & 0xffffffff);
+  if((fp = fopen(file, "r")) == 0){
+    io_printf((char *)"Error: can not open %s for reading\n", file);
+    return -1;
   }
-  free(line);
+  fclose(fp);
+  image = b_create();
+  read_mem(file, &image);
+  b_walk(image, patch_atom, 0);
+  b_destroy(image);
+  for(int idx = 0; idx < 32; idx++)pli_var.last_addr[idx] = (KeyType)-1;
+  return 0;
 }
-#endif // ifndef PITON_DPI
@@ -0,0 +1,312 @@
+// Modified by Princeton University on June 9th, 2015
+// ========== Copyright Header Begin ==========================================
+//
+// OpenSPARC T1 Processor File: iob_main.cc
+// Copyright (c) 2006 Sun Microsystems, Inc.  All Rights Reserved.
+// DO NOT ALTER OR REMOVE COPYRIGHT NOTICES.
+//
+// The above named program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public
+// License version 2 as published by the Free Software Foundation.
+//
+// The above named program is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public
+// License along with this work; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+//
+// ========== Copyright Header End ============================================
+// PLI adapter of the iob and memory model, split from iob_main.cc. The
+// tasks are registered through VPI by iob_pli_register(), from
+// vlog_startup_routines for vcs (built with IOB_VPI_STARTUP) and from
+// veriuser.c or vpi_user.c for the other simulators. The compiletf of
+// every call site collects its argument handles once, the calltf reuses
+// them; values move as vpiVectorVal, no string formatting and no handle
+// lookups on the per-cycle path.
+#ifndef PITON_DPI
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include "global.h"
+#include "bw_lib.h"
+#include "iob_sim.h"
+#include "vpi_user.h"
+
+extern "C" void iob_pli_register();
+
+//file used for oram init
+static FILE *oram_fp = NULL;
+/*------------------------------------------
+simulator hooks of the model, plusargs and
+time are in iob_sim.cc.
+-------------------------------------------*/
+void iob_sim_finish()
+{
+  vpi_control(vpiFinish, 1);
+}
+/*------------------------------------------
+a task and the least number of arguments
+its call sites must have.
+-------------------------------------------*/
+struct pli_task {
+  const char* name;
+  PLI_INT32   (*call)(PLI_BYTE8*);
+  int         args;
+};
+/*------------------------------------------
+arguments of one call site, args[1] is the
+first one as with tf_getp, wide tells the
+ones of more than 32 bits.
+-------------------------------------------*/
+struct pli_call {
+  std::vector<vpiHandle> args;
+  std::vector<char>      wide;
+};
+/*------------------------------------------
+compiletf of all tasks, the handles stay
+valid for the whole simulation.
+-------------------------------------------*/
+static PLI_INT32 pli_compile(PLI_BYTE8* data)
+{
+  pli_task* task = (pli_task*)data;
+  pli_call* call = new pli_call;
+  vpiHandle systf, iter, arg;
+
+  systf = vpi_handle(vpiSysTfCall, NULL);
+  call->args.assign(1, (vpiHandle) NULL);
+  call->wide.assign(1, 0);
+  iter = vpi_iterate(vpiArgument, systf);
+  if(iter != NULL){
+    while((arg = vpi_scan(iter)) != NULL){
+      call->args.push_back(arg);
+      call->wide.push_back(vpi_get(vpiSize, arg) > 32);
+    }
+  }
+  if((int)call->args.size() - 1 < task->args){
+    io_printf((char *)"Error: %s needs %d arguments, got %d\n", task->name,
+              task->args, (int)call->args.size() - 1);
+    vpi_control(vpiFinish, 1);
+  }
+  vpi_put_userdata(systf, call);
+  vpi_free_object(systf);
+  return 0;
+}
+/*------------------------------------------
+arguments of the running call site.
+-------------------------------------------*/
+static pli_call* pli_this()
+{
+  vpiHandle systf = vpi_handle(vpiSysTfCall, NULL);
+  pli_call* call  = (pli_call*)vpi_get_userdata(systf);
+
+  vpi_free_object(systf);
+  return call;
+}
+
+static unsigned long long pli_get(pli_call* call, int idx)
+{
+  s_vpi_value value;
+  unsigned long long val;
+
+  value.format = vpiVectorVal;
+  vpi_get_value(call->args[idx], &value);
+  val = (unsigned)value.value.vector[0].aval;
+  if(call->wide[idx])val |= (unsigned long long)(unsigned)value.value.vector[1].aval << 32;
+  return val;
+}
+
+static void pli_put(pli_call* call, int idx, unsigned long long val)
+{
+  s_vpi_vecval vec[2];
+  s_vpi_value  value;
+
+  vec[0].aval = val & 0xffffffff;
+  vec[0].bval = 0;
+  vec[1].aval = val >> 32;
+  vec[1].bval = 0;
+  value.format       = vpiVectorVal;
+  value.value.vector = vec;
+  vpi_put_value(call->args[idx], &value, NULL, vpiNoDelay);
+}
+/*------------------------------------------
+pli argument 1 : memory image
+pli argument 2 : use oram
+-------------------------------------------*/
+static PLI_INT32 init_jbus_model_call(PLI_BYTE8*)
+{
+  pli_call*   call = pli_this();
+  s_vpi_value value;
+  std::string image;
+  char* seed;
+
+  value.format = vpiStringVal;
+  vpi_get_value(call->args[1], &value);
+  image = value.value.str;
+  seed = iob_sim_plusargs("tg_seed=");
+  if(seed){
+    srand(atoi(seed));
+    srandom(atoi(seed));
+    set_tg_seed(atoi(seed));
+  }
+  iob_model_init((char *)image.c_str(), (char *)"diag.ev", pli_get(call, 2));
+  return 0;
+}
+/*------------------------------------------
+ drive the cpx packet on arg, word 0 of the
+ packet holds the top bits.
+-------------------------------------------*/
+static void drive_cpx_arg(vpiHandle arg, const int* pkt)
+{
+  s_vpi_vecval vec[CPX_WORDS];
+  s_vpi_value  value;
+  int idx;
+
+  for(idx = 0; idx < CPX_WORDS; idx++){
+    vec[idx].aval = pkt[CPX_WORDS - 1 - idx];
+    vec[idx].bval = 0;
+  }
+  value.format       = vpiVectorVal;
+  value.value.vector = vec;
+  vpi_put_value(arg, &value, NULL, vpiNoDelay);
+}
+/*------------------------------------------
+handle the cmp clock domain jobs.
+layout of $iob_cdriver:
+1). cpx packet (output)
+2). pairs of inst_done, phyical pc for every core.
+-------------------------------------------*/
+static PLI_INT32 iob_cdrive_call(PLI_BYTE8*)
+{
+  pli_call* call = pli_this();
+  size_t    idx;
+
+  for(idx = PC_EVENT; idx + 1 < call->args.size(); idx += 2){
+    if(pli_get(call, idx)){//check instruction done
+      iob_model_pc(pli_get(call, idx+1) & 0xffffffffffffULL);
+    }
+  }
+  if(iob_model_cycle())drive_cpx_arg(call->args[CPX_LOC], iob_model_cpx());
+  return 0;
+}
+
+// get 64b of data from memory
+static PLI_INT32 read_64b_call(PLI_BYTE8*)
+{
+  pli_call* call = pli_this();
+
+  pli_put(call, 2, iob_model_read(pli_get(call, 1)));
+  return 0;
+}
+
+// put 64b of data to memory
+static PLI_INT32 write_64b_call(PLI_BYTE8*)
+{
+  pli_call* call = pli_this();
+
+  iob_model_write(pli_get(call, 1), pli_get(call, 2));
+  return 0;
+}
+
+/*------------------------------------------
+repeatedly call this to get the queue
+pli argument 1 : filename
+pli argument 2 : done (output)
+pli argument 3 : addr (output)
+pli argument 4 : val0 (output)
+pli argument 5 : val1 (output)
+pli argument 6 : val2 (output)
+pli argument 7 : val3 (output)
+pli argument 8 : val4 (output)
+pli argument 9 : val5 (output)
+pli argument 10: val6 (output)
+pli argument 11: val7 (output)
+-------------------------------------------*/
+static PLI_INT32 init_oram_call(PLI_BYTE8*){
+  pli_call* call = pli_this();
+  s_vpi_value value;
+
+  size_t len = 0;
+  size_t read;
+  char *line = NULL;
+
+  char buf[9][17];
+
+  unsigned long long addr;
+  unsigned long long val[8];
+
+  int i;
+
+
+  if (oram_fp == NULL) {
+          value.format = vpiStringVal;
+          vpi_get_value(call->args[1], &value);// a get file name.
+          oram_fp = fopen(value.value.str, "r");
+  }
+
+  if (oram_fp == NULL) {
+          perror("open()");
+          exit(1);
+  }
+
+  read = getline(&line, &len, oram_fp);
+
+  if (read == -1) {
+          pli_put(call, 2, 1); //done = 1
+  } else {
+          pli_put(call, 2, 0); //done = 0
+          sscanf(line, "%s %s %s %s %s %s %s %s %s\n",
+                 (char *)(&buf[0]), (char *)(&buf[1]),
+                 (char *)(&buf[2]), (char *)(&buf[3]),
+                 (char *)(&buf[4]), (char *)(&buf[5]),
+                 (char *)(&buf[6]), (char *)(&buf[7]),
+                 (char *)(&buf[8]));
+          addr = strtoul(buf[0], NULL, 16);
+          //io_printf("oram init. addr: %x\n", addr);
+          pli_put(call, 3, addr);
+          for (i = 1; i < 9; i++)
+                  val[i-1] = strtoul(buf[i], NULL, 16);
+          for (i = 4; i < 4 + 8; i++)
+                  pli_put(call, i, val[i-4]);
+  }
+  free(line);
+  return 0;
+}
+
+static pli_task pli_tasks[] = {
+  {"$init_jbus_model", init_jbus_model_call, 2},
+  {"$iob_cdriver",     iob_cdrive_call,      1},
+  {"$read_64b",        read_64b_call,        2},
+  {"$write_64b",       write_64b_call,       2},
+  {"$init_oram",       init_oram_call,       11},
+  {0, 0, 0}
+};
+/*------------------------------------------
+register the tasks of the model.
+-------------------------------------------*/
+void iob_pli_register()
+{
+  s_vpi_systf_data data;
+  pli_task*        task;
+
+  for(task = pli_tasks; task->name; task++){
+    data.type        = vpiSysTask;
+    data.sysfunctype = 0;
+    data.tfname      = (PLI_BYTE8 *)task->name;
+    data.calltf      = task->call;
+    data.compiletf   = pli_compile;
+    data.sizetf      = 0;
+    data.user_data   = (PLI_BYTE8 *)task;
+    vpi_register_systf(&data);
+  }
+}
+
+#ifdef IOB_VPI_STARTUP
+extern "C" {
+void (*vlog_startup_routines[])() = { iob_pli_register, 0 };
+}
+#endif // ifdef IOB_VPI_STARTUP
+#endif // ifndef PITON_DPI
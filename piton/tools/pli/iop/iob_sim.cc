@@ -0,0 +1,81 @@
+/*
+Copyright (c) 2019 Princeton University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Princeton University nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY PRINCETON UNIVERSITY "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL PRINCETON UNIVERSITY BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/*------------------------------------------
+iob_sim.cc
+simulator hooks shared by the adapters (iob_sim.h).
+verilator has its own plusargs and time, every
+other simulator answers through VPI, with the
+PLI tasks of iob_pli.cc as with the DPI-C
+functions of iob_dpi.cc.
+-------------------------------------------*/
+#include <string.h>
+#include "global.h"
+#include "iob_sim.h"
+#ifndef VERILATOR
+#include "vpi_user.h"
+#endif // ifndef VERILATOR
+
+#ifdef VERILATOR
+// provided by the verilator harness
+extern double sc_time_stamp();
+#endif // ifdef VERILATOR
+/*------------------------------------------
+value of +name, 0 when it is not given.
+-------------------------------------------*/
+char* iob_sim_plusargs(const char* name)
+{
+#ifdef VERILATOR
+  const char* match = Verilated::commandArgsPlusMatch(name);
+  if(match[0] == '\0')return (char *) 0;
+  return (char *)match + 1 + strlen(name);
+#else // ifdef VERILATOR
+  s_vpi_vlog_info info;
+  size_t len = strlen(name);
+
+  if(!vpi_get_vlog_info(&info))return (char *) 0;
+  for(int idx = 1; idx < info.argc; idx++){
+    char* arg = info.argv[idx];
+    if(arg && arg[0] == '+' && !strncmp(arg + 1, name, len))return arg + 1 + len;
+  }
+  return (char *) 0;
+#endif // ifdef VERILATOR
+}
+/*------------------------------------------
+simulation time in the units of the simulator.
+-------------------------------------------*/
+unsigned long long iob_sim_time()
+{
+#ifdef VERILATOR
+  return (unsigned long long)sc_time_stamp();
+#else // ifdef VERILATOR
+  s_vpi_time now;
+
+  now.type = vpiSimTime;
+  vpi_get_time(NULL, &now);
+  return ((unsigned long long)now.high << 32) | now.low;
+#endif // ifdef VERILATOR
+}
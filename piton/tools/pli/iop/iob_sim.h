@@ -0,0 +1,86 @@
+/*
+Copyright (c) 2019 Princeton University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Princeton University nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY PRINCETON UNIVERSITY "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL PRINCETON UNIVERSITY BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/*******************************************************************************
+    iob_sim.h
+********************************************************************************
+Boundary between the iob/memory model and the simulator.
+
+The model (iob.cc, cpx.cc, pcx.cc, iob_main.cc) never calls VPI or DPI
+routines. It is driven through the iob_model_* entry points and reaches
+back into the simulator only through the iob_sim_* hooks:
+  iob_pli.cc  system tasks ($iob_cdriver, $read_64b, ...) on VPI for vcs,
+              ncverilog, icarus, modelsim and riviera
+  iob_dpi.cc  DPI-C functions (drive_iob_pkt, read_64b_call, ...) for verilator
+              and any simulator built with PITON_DPI
+  iob_sim.cc  plusargs and time of both, through VPI or verilator
+Packets cross the boundary as binary 32 bit words, never as strings.
+*/
+#ifndef _IOB_SIM_H_
+#define _IOB_SIM_H_
+#include "global.h"
+
+//number of 32 bit words of a cpx packet, word 0 holds bits [144:128].
+#define CPX_WORDS 5
+
+//model entry points, used by the adapters.
+void iob_model_init(char* mem_file, char* ev_file, int oram);
+//end of a test, writes the statistics and frees the memory, the next
+//iob_model_init starts from scratch (batch runs).
+void iob_model_done();
+//in a child of fork(), the statistics files move to its directory.
+void iob_model_fork();
+int  iob_model_cycle();
+int  iob_model_cpx_valid();
+const int* iob_model_cpx();
+void iob_model_pc(unsigned long long pc);
+unsigned long long iob_model_read(KeyType key);
+void iob_model_write(KeyType key, unsigned long long val);
+//number of memory lines present in [key, key + size).
+int  iob_model_lines(KeyType key, unsigned long long size);
+//checkpoint of the memory and the iob state, return 0 on success.
+//restore is called after iob_model_init, diag.ev is not part of it.
+int  iob_model_save(const char* file);
+int  iob_model_restore(const char* file);
+//the iob state alone, without memory and pc event counters, as at the
+//end of reset. restore_state keeps what iob_model_init loaded.
+int  iob_model_save_state(const char* file);
+int  iob_model_restore_state(const char* file);
+//overlay a memory image on the current memory (workload after boot).
+int  iob_model_load(char* mem_file);
+
+//read_64b/write_64b calls of the simulator, counted by the dpi adapter
+//for the live statistics of the verilator harness.
+extern unsigned long long iob_mem_reads;
+extern unsigned long long iob_mem_writes;
+
+//simulator hooks, provided by the adapter.
+//value of +name, 0 when it is not given. under verilator the value lives
+//in a buffer the next call overwrites, copy or convert it first.
+char* iob_sim_plusargs(const char* name);
+unsigned long long iob_sim_time();
+void  iob_sim_finish();
+#endif
@@ -0,0 +1,163 @@
+/*
+Copyright (c) 2019 Princeton University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Princeton University nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY PRINCETON UNIVERSITY "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL PRINCETON UNIVERSITY BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "iob_stats.h"
+
+static iob_stats* exit_stats = 0;
+static int exit_set = 0;//atexit done, init is called again per batch test
+/*------------------------------------------
+  write the summary when the simulator exits.
+--------------------------------------------*/
+static void iob_stats_at_exit()
+{
+  if(exit_stats)exit_stats->finish();
+}
+/*------------------------------------------
+  clear histogram.
+--------------------------------------------*/
+void iob_hist::clean()
+{
+  int i;
+  count = sum = max = 0;
+  for(i = 0; i < IOB_HIST_BINS; i++)bins[i] = 0;
+}
+/*------------------------------------------
+  record one latency.
+--------------------------------------------*/
+void iob_hist::add(unsigned long long val)
+{
+  int bin = 0;
+  while(bin < IOB_HIST_BINS - 1 && (val >> bin))bin++;
+  bins[bin]++;
+  count++;
+  sum += val;
+  if(val > max)max = val;
+}
+/*------------------------------------------
+  "name":{"count":..,"sum":..,"max":..,"bins":[..]}
+--------------------------------------------*/
+void iob_hist::dump(FILE* fp, const char* name)
+{
+  int i;
+  fprintf(fp, "\"%s\":{\"count\":%llu,\"sum\":%llu,\"max\":%llu,\"bins\":[",
+          name, count, sum, max);
+  for(i = 0; i < IOB_HIST_BINS; i++)fprintf(fp, i ? ",%llu" : "%llu", bins[i]);
+  fprintf(fp, "]}");
+}
+/*------------------------------------------
+  open name.jsonl, 0 disables the snapshots.
+--------------------------------------------*/
+void iob_stats::open_snapshots()
+{
+  char file[BUFFER + 8];
+
+  snprintf(file, sizeof(file), "%s.jsonl", name);
+  if((snap_fp = fopen(file, "w")) == 0){
+    io_printf((char *)"Warning: can not open %s, snapshots disabled\n", file);
+    period = 0;
+  }
+}
+/*------------------------------------------
+  reset counters, snapshot_period 0 disables
+  the periodic snapshots. file is the name of
+  the summary and snapshots, iob_stats if 0.
+--------------------------------------------*/
+void iob_stats::init(int snapshot_period, const char* file)
+{
+  int i;
+  cycles = 0;
+  pcx_enq = pcx_xlated = cpx_req = cpx_sent = 0;
+  in_flight = max_in_flight = 0;
+  for(i = 0; i < IOB_STATS_CPUS; i++)qsel_stall[i] = 0;
+  pcx_wait.clean();
+  cpx_grant.clean();
+  period  = snapshot_period > 0 ? snapshot_period : 0;
+  snap_fp = 0;
+  snprintf(name, sizeof(name), "%s", file ? file : "iob_stats");
+  if(period)open_snapshots();
+  if(exit_set == 0)atexit(iob_stats_at_exit);
+  exit_set   = 1;
+  exit_stats = this;
+}
+/*------------------------------------------
+  the FILE of the parent still points at its
+  file, it was flushed before the fork.
+--------------------------------------------*/
+void iob_stats::reopen()
+{
+  if(snap_fp == 0)return;
+  fclose(snap_fp);
+  open_snapshots();
+}
+/*------------------------------------------
+  one iob cycle.
+--------------------------------------------*/
+void iob_stats::tick()
+{
+  cycles++;
+  if(period && (cycles % period) == 0){
+    dump(snap_fp);
+    fflush(snap_fp);
+  }
+}
+/*------------------------------------------
+  one JSON object per line.
+--------------------------------------------*/
+void iob_stats::dump(FILE* fp)
+{
+  int i;
+  fprintf(fp, "{\"cycles\":%llu,\"pcx_enq\":%llu,\"pcx_xlated\":%llu,"
+          "\"cpx_req\":%llu,\"cpx_sent\":%llu,\"in_flight\":%llu,"
+          "\"max_in_flight\":%llu,\"qsel_stall\":[",
+          cycles, pcx_enq, pcx_xlated, cpx_req, cpx_sent, in_flight, max_in_flight);
+  for(i = 0; i < IOB_STATS_CPUS; i++)fprintf(fp, i ? ",%llu" : "%llu", qsel_stall[i]);
+  fprintf(fp, "],");
+  pcx_wait.dump(fp, "pcx_wait");
+  fprintf(fp, ",");
+  cpx_grant.dump(fp, "cpx_grant");
+  fprintf(fp, "}\n");
+}
+/*------------------------------------------
+  end of simulation summary.
+--------------------------------------------*/
+void iob_stats::finish()
+{
+  FILE* fp;
+  char  file[BUFFER + 8];
+  if(snap_fp){
+    fclose(snap_fp);
+    snap_fp = 0;
+    period  = 0;
+  }
+  snprintf(file, sizeof(file), "%s.json", name);
+  if((fp = fopen(file, "w")) == 0){
+    io_printf((char *)"Warning: can not write %s\n", file);
+    return;
+  }
+  dump(fp);
+  fclose(fp);
+  exit_stats = 0;
+}
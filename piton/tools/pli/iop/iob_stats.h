@@ -0,0 +1,83 @@
+/*
+Copyright (c) 2019 Princeton University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Princeton University nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY PRINCETON UNIVERSITY "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL PRINCETON UNIVERSITY BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+/*******************************************************************************
+    iob_stats.h
+********************************************************************************
+Throughput and latency counters of the fake iob.
+
+Time is counted in do_iob() calls, i.e. cmp clock cycles while ok_iob is
+set. A JSON summary is written to iob_stats.json at exit;
++iob_stats_period=N also appends a snapshot every N cycles to
+iob_stats.jsonl (one JSON object per line). +iob_stats_file=NAME writes
+NAME.json and NAME.jsonl instead, the batch mode of the verilator harness
+names them per test.
+*/
+#ifndef _IOB_STATS_H_
+#define _IOB_STATS_H_
+#include <stdio.h>
+#include "global.h"
+
+#define IOB_HIST_BINS  16
+#define IOB_STATS_CPUS 8
+
+//power of two latency histogram.
+//bin 0 holds zero, bin i holds [2^(i-1), 2^i), the last bin the rest.
+class iob_hist{
+public:
+  unsigned long long count, sum, max;
+  unsigned long long bins[IOB_HIST_BINS];
+  void clean();
+  void add(unsigned long long val);
+  void dump(FILE* fp, const char* name);
+};
+
+class iob_stats{
+private:
+  int period;
+  FILE* snap_fp;
+  //file names without .json/.jsonl
+  char name[BUFFER];
+  void dump(FILE* fp);
+  void open_snapshots();
+public:
+  unsigned long long cycles;
+  //packet counters
+  unsigned long long pcx_enq, pcx_xlated, cpx_req, cpx_sent;
+  unsigned long long in_flight, max_in_flight;
+  //cycles the head cpx packet waited for a free qsel slot, per cpu.
+  unsigned long long qsel_stall[IOB_STATS_CPUS];
+  iob_hist pcx_wait;  //enqueue -> xlation
+  iob_hist cpx_grant; //xlation -> cpx packet driven
+  void init(int snapshot_period, const char* file);
+  //after fork(), the snapshots start over in the directory of the child
+  void reopen();
+  void tick();
+  void enqueue(){pcx_enq++;if(++in_flight > max_in_flight)max_in_flight = in_flight;}
+  void retire(){cpx_sent++;in_flight--;}
+  void finish();
+};
+#endif
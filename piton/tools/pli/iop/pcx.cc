@@ -20,12 +20,22 @@
 // 
 // ========== Copyright Header End ============================================
 #include "pcx.h"
+#include "bw_lib.h"
+/*------------------------------------------
+  seed from tg_seed, one stream per object.
+--------------------------------------------*/
+unsigned int pcx::instances = 0;
+void pcx::seed_rng()
+{
+  bw_rng_seed(&rng, get_tg_seed(), BW_RNG_STREAM(BW_RNG_STREAM_PCX, instances++));
+}
 /*------------------------------------------
   constructor.
 --------------------------------------------*/
 pcx::pcx(int* p)
 {
-  wait = random() & 0x7;
+  seed_rng();
+  wait = bw_rng_next(&rng) & 0x7;
   for(idx = 0; idx < 4;idx++)pkt[idx] = p[idx];
 }
 /*------------------------------------------
@@ -25,25 +25,33 @@
 #ifndef _PCX_H_
 #define _PCX_H_
 #include "global.h"
+#include "bw_rng.h"
 #define PCX_SIZE 4
 
 class pcx{
  //start private funcs and variable here
 private:
   int idx;
+  //private random stream of this packet holder.
+  bw_rng rng;
+  void seed_rng();
 
 public:
   //public pcx packet field vaiable
   char  cpu_id; 
   char  thrid;
   int true_id;
+  //number of streams handed out, rewound between batch tests.
+  static unsigned int instances;
 
   char  wait ;
+  //iob cycle the packet was queued.
+  unsigned long long stamp;
   //pkt holds the pcx packet.
   int pkt[4];
   //constructor
   pcx(int* pkt);
-  pcx(){wait = random() & 0x7;}//no initialize
+  pcx(){seed_rng();wait = bw_rng_next(&rng) & 0x7;}//no initialize
   int  get_delay(){--wait;return wait;}
   void set_delay(){wait = 1;}
   //clean
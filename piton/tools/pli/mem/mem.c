@@ -37,6 +37,7 @@ vcs +mon0=cpu0:25 +mon1=ccx:10
 #include "acc_user.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include "bw_rng.h"
 #ifdef __ICARUS__
 #include "icarus-compat.h"
 #endif
@@ -147,6 +148,21 @@ char syndrome(char* data, int fl)
   }
   return ch;
 }
+/*-------------------------------------------------------------------------------
+  stream of a slammed target, a hash of the calling instance and the name of
+  the argument: every register file gets values of its own, the same ones
+  whatever the order of the calls.
+--------------------------------------------------------------------------------*/
+static unsigned int slam_stream(const char* node)
+{
+  unsigned int hash = 2166136261u;//fnv-1a
+  const char*  ptr;
+
+  for(ptr = tf_mipname(); ptr && *ptr; ptr++)hash = (hash ^ (unsigned char)*ptr) * 16777619u;
+  hash = (hash ^ '.') * 16777619u;
+  for(ptr = node; ptr && *ptr; ptr++)hash = (hash ^ (unsigned char)*ptr) * 16777619u;
+  return hash;
+}
 /*-------------------------------------------------------------------------------
   slam memory with random.
 8: initial -> irf register
@@ -160,18 +176,19 @@ int slam_random_call()
   char  *pargs;
   
   unsigned int seed;
+  bw_rng rng;
 
   s_tfnodeinfo node_info;
   tf_nodeinfo(1, &node_info);
+  seed  = 0;
   pargs = mc_scan_plusargs ("tg_seed=");  
   if(pargs != (char *) 0) {
     seed = atoi(pargs);
-    srand(seed);
-    srandom(seed);
   }
+  bw_rng_seed(&rng, seed, BW_RNG_STREAM(BW_RNG_STREAM_SLAM, slam_stream(node_info.node_symbol)));
   if(tf_getp(3) == 2){
     for(groups = 0; groups < node_info.node_ngroups ; groups++){
-      node_info.node_value.vecval_p[groups].avalbits = random() & 0xffffffff;
+      node_info.node_value.vecval_p[groups].avalbits = bw_rng_next(&rng);
       node_info.node_value.vecval_p[groups].bvalbits = 0;
     }
     tf_propagatep(1);
@@ -198,7 +215,7 @@ int slam_random_call()
 	  bvalPtr[groups] = 0;
 	  continue;
 	}
-	ch              = rnd ? random() & 0xff : val;
+	ch              = rnd ? bw_rng_next(&rng) & 0xff : val;
 	avalPtr[groups] = ch;
 	bvalPtr[groups] = 0;
 	data[ind]     = ch;
@@ -0,0 +1,137 @@
+/*
+Copyright (c) 2019 Princeton University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Princeton University nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY PRINCETON UNIVERSITY "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL PRINCETON UNIVERSITY BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// DPI-C adapter of playback_io.h for the playback dump and driver modules,
+// the imports are in verif/env/manycore/playback_dpi.vh. The vectors pass
+// as logic [PLAYBACK_MAX_WIDTH-1:0], the widths given to playback_open()
+// are the bits that go to the file.
+
+#include "playback_io.h"
+#include "svdpi.h"
+#include <string.h>
+
+// the width of the vectors of the imports
+#define PLAYBACK_MAX_WIDTH 512
+
+struct playback_handle {
+    bool write;
+    std::string name;
+    playback_writer writer;
+    playback_reader reader;
+    uint32_t input_width;
+    uint32_t output_width;
+    uint64_t records;
+};
+
+extern "C" void* playback_open(const char* name, const char* mode, int input_width, int output_width);
+extern "C" void playback_write(void* handle, const svLogicVecVal* in, const svLogicVecVal* out);
+extern "C" int playback_read(void* handle, svLogicVecVal* in, svLogicVecVal* out);
+extern "C" void playback_close(void* handle);
+
+// copies width bits of a vector, the bits above are 0
+static void copy_vector(uint32_t* dst, const uint32_t* src, uint32_t width) {
+    uint32_t words = playback_words(width);
+    memcpy(dst, src, 2 * words * sizeof(uint32_t));
+    if (width % 32) {
+        uint32_t mask = (1u << (width % 32)) - 1;
+        dst[2 * words - 2] &= mask;
+        dst[2 * words - 1] &= mask;
+    }
+    memset(dst + 2 * words, 0, 2 * (playback_words(PLAYBACK_MAX_WIDTH) - words) * sizeof(uint32_t));
+}
+
+void* playback_open(const char* name, const char* mode, int input_width, int output_width) {
+    if (input_width <= 0 || output_width <= 0 ||
+        input_width > PLAYBACK_MAX_WIDTH || output_width > PLAYBACK_MAX_WIDTH) {
+        printf("Error: playback vectors of %d/%d bits, at most %d\n",
+               input_width, output_width, PLAYBACK_MAX_WIDTH);
+        return NULL;
+    }
+    playback_handle* h = new playback_handle;
+    h->write = mode[0] == 'w';
+    h->name = name;
+    h->input_width = input_width;
+    h->output_width = output_width;
+    h->records = 0;
+
+    bool ok = h->write ? h->writer.open(name, input_width, output_width)
+                       : h->reader.open(name, input_width, output_width);
+    if (!ok) {
+        printf("Error: playback %s\n", (h->write ? h->writer.error() : h->reader.error()).c_str());
+        delete h;
+        return NULL;
+    }
+    if (!h->write) {
+        printf("playback: %s stimulus %s\n", h->reader.is_binary() ? "binary" : "text", name);
+    }
+    return h;
+}
+
+void playback_write(void* handle, const svLogicVecVal* in, const svLogicVecVal* out) {
+    playback_handle* h = (playback_handle*) handle;
+    if (!h || !h->write) {
+        return;
+    }
+    uint32_t vin[2 * playback_words(PLAYBACK_MAX_WIDTH)];
+    uint32_t vout[2 * playback_words(PLAYBACK_MAX_WIDTH)];
+    copy_vector(vin, (const uint32_t*) in, h->input_width);
+    copy_vector(vout, (const uint32_t*) out, h->output_width);
+    h->writer.write(vin, vout);
+    h->records++;
+}
+
+// 1 with the next record in in and out, 0 at the end of the stimulus, -2
+// when a corrupt record ended it (-1 is the end of file of $fscanf)
+int playback_read(void* handle, svLogicVecVal* in, svLogicVecVal* out) {
+    playback_handle* h = (playback_handle*) handle;
+    if (!h || h->write) {
+        return 0;
+    }
+    uint32_t vin[2 * playback_words(PLAYBACK_MAX_WIDTH)];
+    uint32_t vout[2 * playback_words(PLAYBACK_MAX_WIDTH)];
+    if (!h->reader.next(vin, vout)) {
+        if (!h->reader.error().empty()) {
+            printf("Error: playback %s\n", h->reader.error().c_str());
+            return -2;
+        }
+        return 0;
+    }
+    copy_vector((uint32_t*) in, vin, h->input_width);
+    copy_vector((uint32_t*) out, vout, h->output_width);
+    h->records++;
+    return 1;
+}
+
+void playback_close(void* handle) {
+    playback_handle* h = (playback_handle*) handle;
+    if (!h) {
+        return;
+    }
+    printf("playback: %llu records %s %s\n", (unsigned long long) h->records,
+           h->write ? "written to" : "read from", h->name.c_str());
+    delete h;
+}
@@ -0,0 +1,357 @@
+/*
+Copyright (c) 2019 Princeton University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Princeton University nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY PRINCETON UNIVERSITY "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL PRINCETON UNIVERSITY BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Stimulus files of the playback environments, see playback_io.h.
+
+#include "playback_io.h"
+#include <errno.h>
+#include <string.h>
+
+static bool ends_with(const std::string& s, const char* suffix) {
+    size_t n = strlen(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+FILE* playback_fopen(const std::string& name, const char* mode, bool& piped, std::string& err) {
+    bool write = mode[0] == 'w';
+    const char* tool = NULL;
+    FILE* file;
+
+    if (write) {
+        tool = ends_with(name, ".gz") ? "gzip" : ends_with(name, ".zst") ? "zstd -q" : NULL;
+    } else {
+        // the magic of a compressed file, not its name
+        file = fopen(name.c_str(), "rb");
+        if (!file) {
+            err = "can not open '" + name + "': " + strerror(errno);
+            return NULL;
+        }
+        unsigned char magic[4] = {0, 0, 0, 0};
+        size_t n = fread(magic, 1, sizeof(magic), file);
+        if (n >= 2 && magic[0] == 0x1f && magic[1] == 0x8b) {
+            tool = "gzip -d";
+        } else if (n == 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd) {
+            tool = "zstd -q -d";
+        }
+        if (!tool) {
+            rewind(file);
+            piped = false;
+            setvbuf(file, NULL, _IOFBF, 1 << 20);
+            return file;
+        }
+        fclose(file);
+    }
+
+    if (tool) {
+        if (name.find('\'') != std::string::npos) {
+            err = "can not pipe '" + name + "', it has a quote";
+            return NULL;
+        }
+        std::string cmd = std::string(tool) + (write ? " -c > '" : " -c '") + name + "'";
+        file = popen(cmd.c_str(), write ? "w" : "r");
+        piped = true;
+    } else {
+        file = fopen(name.c_str(), "wb");
+        piped = false;
+    }
+    if (!file) {
+        err = "can not open '" + name + "': " + strerror(errno);
+        return NULL;
+    }
+    setvbuf(file, NULL, _IOFBF, 1 << 20);
+    return file;
+}
+
+void playback_fclose(FILE* file, bool piped) {
+    if (piped) {
+        pclose(file);
+    } else {
+        fclose(file);
+    }
+}
+
+int playback_read_text(FILE* file, uint32_t width, uint32_t* rec) {
+    static const int max_token = 4096;
+    char token[max_token];
+    int n = 0;
+    int c;
+
+    do {
+        c = getc_unlocked(file);
+    } while (c == ' ' || c == '\t' || c == '\n' || c == '\r');
+    for (; c != EOF && c != ' ' && c != '\t' && c != '\n' && c != '\r'; c = getc_unlocked(file)) {
+        if (c == 'X' || c == 'Z') {
+            c |= 0x20;
+        }
+        if (c == '0' || c == '1' || c == 'x' || c == 'z') {
+            if (n < max_token) {
+                token[n++] = c;
+            }
+        } else if (c != '_') {
+            while (c != EOF && c != '\n') {
+                c = getc_unlocked(file);
+            }
+            return -1;
+        }
+    }
+    if (n == 0) {
+        return 0;
+    }
+
+    memset(rec, 0, 2 * playback_words(width) * sizeof(uint32_t));
+    for (uint32_t i = 0; i < width && i < (uint32_t) n; i++) {
+        char b = token[n - 1 - i];
+        uint32_t bit = 1u << (i % 32);
+        if (b == '1' || b == 'x') {
+            rec[2 * (i / 32)] |= bit;
+        }
+        if (b == 'x' || b == 'z') {
+            rec[2 * (i / 32) + 1] |= bit;
+        }
+    }
+    return 1;
+}
+
+/*------------------------------------------
+writer
+-------------------------------------------*/
+bool playback_writer::open(const std::string& name, uint32_t input_width, uint32_t output_width) {
+    close();
+    std::string base = name;
+    if (ends_with(base, ".gz")) {
+        base.erase(base.size() - 3);
+    } else if (ends_with(base, ".zst")) {
+        base.erase(base.size() - 4);
+    }
+    binary = !ends_with(base, ".txt");
+
+    file = playback_fopen(name, "w", piped, err);
+    if (!file) {
+        return false;
+    }
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic = PLAYBACK_MAGIC;
+    hdr.version = PLAYBACK_VERSION;
+    hdr.input_width = input_width;
+    hdr.output_width = output_width;
+    if (binary) {
+        fwrite(&hdr, sizeof(hdr), 1, file);
+    }
+    records = 0;
+    return true;
+}
+
+void playback_writer::write_text(const uint32_t* vec, uint32_t width) {
+    static const char digit[4] = {'0', '1', 'z', 'x'};
+    line.resize(width + 1);
+    for (uint32_t i = 0; i < width; i++) {
+        line[width - 1 - i] = digit[playback_bit(vec, i)];
+    }
+    line[width] = '\n';
+    fwrite(line.data(), 1, line.size(), file);
+}
+
+void playback_writer::write(const uint32_t* in, const uint32_t* out) {
+    if (!file) {
+        return;
+    }
+    if (binary) {
+        fwrite(in, sizeof(uint32_t), 2 * playback_words(hdr.input_width), file);
+        fwrite(out, sizeof(uint32_t), 2 * playback_words(hdr.output_width), file);
+    } else {
+        // the layout of $fdisplay(fid, "%b\n%b\n", in, out)
+        write_text(in, hdr.input_width);
+        write_text(out, hdr.output_width);
+        fputc('\n', file);
+    }
+    records++;
+}
+
+void playback_writer::close() {
+    if (file) {
+        playback_fclose(file, piped);
+        file = NULL;
+    }
+}
+
+/*------------------------------------------
+reader, the worker thread parses blocks of records ahead of next().
+-------------------------------------------*/
+playback_reader::playback_reader()
+    : file(NULL), piped(false), binary(false), parsed(0), done(true), stop(false), pos(0) {
+    memset(&hdr, 0, sizeof(hdr));
+}
+
+bool playback_reader::open(const std::string& name, uint32_t input_width, uint32_t output_width) {
+    close();
+    this->name = name;
+    err.clear();
+    file = playback_fopen(name, "r", piped, err);
+    if (!file) {
+        return false;
+    }
+
+    // the binary magic starts with 'P', which is not text
+    int c = getc(file);
+    ungetc(c, file);
+    binary = c == (PLAYBACK_MAGIC & 0xff);
+    if (binary) {
+        if (fread(&hdr, sizeof(hdr), 1, file) != 1 || hdr.magic != PLAYBACK_MAGIC ||
+            hdr.version != PLAYBACK_VERSION) {
+            err = "'" + name + "' is not a playback stimulus";
+            close();
+            return false;
+        }
+        if ((input_width && hdr.input_width != input_width) ||
+            (output_width && hdr.output_width != output_width)) {
+            err = "'" + name + "' has vectors of " + std::to_string(hdr.input_width) + "/" +
+                  std::to_string(hdr.output_width) + " bits, expected " +
+                  std::to_string(input_width) + "/" + std::to_string(output_width);
+            close();
+            return false;
+        }
+    } else {
+        memset(&hdr, 0, sizeof(hdr));
+        hdr.magic = PLAYBACK_MAGIC;
+        hdr.version = PLAYBACK_VERSION;
+        hdr.input_width = input_width;
+        hdr.output_width = output_width;
+    }
+
+    blocks.clear();
+    current.clear();
+    pos = 0;
+    parsed = 0;
+    done = false;
+    stop = false;
+    worker = std::thread(&playback_reader::prefetch, this);
+    return true;
+}
+
+// false at the end of the file, with err set when the end is not at a
+// record boundary. Runs on the worker, next() reads err after done.
+bool playback_reader::read_record(uint32_t* rec) {
+    std::string at = "record " + std::to_string(parsed + 1) + " of '" + name + "'";
+    if (binary) {
+        size_t n = fread(rec, sizeof(uint32_t), record_words(), file);
+        if (n == record_words()) {
+            parsed++;
+            return true;
+        }
+        if (n) {
+            err = at + " is truncated, " + std::to_string(n * sizeof(uint32_t)) + " of " +
+                  std::to_string(record_words() * sizeof(uint32_t)) + " bytes";
+        }
+        return false;
+    }
+    uint32_t* rec_out = rec + 2 * playback_words(hdr.input_width);
+    int in = playback_read_text(file, hdr.input_width, rec);
+    int out = in == 1 ? playback_read_text(file, hdr.output_width, rec_out) : 0;
+    if (in == 1 && out == 1) {
+        parsed++;
+        return true;
+    }
+    if (in < 0 || out < 0) {
+        err = at + " has a character that is not 0/1/x/z";
+    } else if (in == 1) {
+        err = at + " has no output vector";
+    }
+    return false;
+}
+
+void playback_reader::prefetch() {
+    size_t words = record_words();
+    for (;;) {
+        std::vector<uint32_t> block(block_records * words);
+        size_t n = 0;
+        while (n < block_records && read_record(&block[n * words])) {
+            n++;
+        }
+        block.resize(n * words);
+
+        std::unique_lock<std::mutex> guard(lock);
+        while (blocks.size() >= max_blocks && !stop) {
+            cond.wait(guard);
+        }
+        if (stop) {
+            break;
+        }
+        if (n) {
+            blocks.push_back(std::move(block));
+        }
+        if (n < block_records) {
+            break;
+        }
+        cond.notify_all();
+    }
+    std::lock_guard<std::mutex> guard(lock);
+    done = true;
+    cond.notify_all();
+}
+
+bool playback_reader::next(uint32_t* in, uint32_t* out) {
+    if (pos >= current.size()) {
+        if (!file) {
+            return false;
+        }
+        std::unique_lock<std::mutex> guard(lock);
+        while (blocks.empty() && !done) {
+            cond.wait(guard);
+        }
+        if (blocks.empty()) {
+            return false;
+        }
+        current = std::move(blocks.front());
+        blocks.pop_front();
+        pos = 0;
+        cond.notify_all();
+    }
+    size_t in_words = 2 * playback_words(hdr.input_width);
+    memcpy(in, &current[pos], in_words * sizeof(uint32_t));
+    memcpy(out, &current[pos + in_words], (record_words() - in_words) * sizeof(uint32_t));
+    pos += record_words();
+    return true;
+}
+
+void playback_reader::close() {
+    if (worker.joinable()) {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stop = true;
+            cond.notify_all();
+        }
+        worker.join();
+    }
+    if (file) {
+        playback_fclose(file, piped);
+        file = NULL;
+    }
+    blocks.clear();
+    current.clear();
+    pos = 0;
+    done = true;
+}
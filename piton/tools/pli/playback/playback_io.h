@@ -0,0 +1,168 @@
+/*
+Copyright (c) 2019 Princeton University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Princeton University nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY PRINCETON UNIVERSITY "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL PRINCETON UNIVERSITY BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Stimulus files of the playback environments (verif/env/manycore/
+// playback_dump*.v and playback_driver*.v).
+//
+// A stimulus is a sequence of records, one per cycle, each an input
+// vector followed by the expected output vector. The text format of the
+// dump modules writes every bit as a 0/1/x/z character, most significant
+// bit first, one vector per line. The binary format keeps the 4-state
+// vectors as the aval/bval words of svLogicVecVal, least significant word
+// first, after a header with the two widths:
+//   header   playback_header, host byte order (the simulation hosts are
+//            little endian)
+//   record   2*playback_words(input_width) words of the input vector,
+//            then 2*playback_words(output_width) words of the output
+// Bits above the width are 0. A name ending in .gz or .zst is written
+// through gzip or zstd, a compressed file is recognized by its magic and
+// read through the same tool.
+//
+// playback_reader reads both formats on a thread of its own, blocks of
+// records are parsed ahead of the simulation so replay does not wait for
+// the file or the decompressor.
+
+#ifndef PLAYBACK_IO_H
+#define PLAYBACK_IO_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define PLAYBACK_MAGIC    0x31564250u  // "PBV1"
+#define PLAYBACK_VERSION  1
+
+struct playback_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t input_width;
+    uint32_t output_width;
+    uint32_t reserved[4];
+};
+
+// 32 bit words of a vector of width bits, each one an aval/bval pair
+static inline uint32_t playback_words(uint32_t width) {
+    return (width + 31) / 32;
+}
+
+// 4-state bit i of a record vector, 0 1 2 (z) 3 (x) as aval | bval << 1
+static inline int playback_bit(const uint32_t* vec, uint32_t i) {
+    return (vec[2 * (i / 32)] >> (i % 32) & 1) | (vec[2 * (i / 32) + 1] >> (i % 32) & 1) << 1;
+}
+
+// opens name for reading or writing ("r" or "w"), through a decompressor
+// or compressor when the name or the magic says so (piped is set then).
+// Returns NULL with err set on failure, close with playback_fclose().
+FILE* playback_fopen(const std::string& name, const char* mode, bool& piped, std::string& err);
+void playback_fclose(FILE* file, bool piped);
+
+// parses one text vector of width bits into rec, 1 with a vector, 0 at the
+// end of the file, -1 at a character that is not 0/1/x/z/_ (its line is
+// consumed). Shorter lines are zero extended, longer ones keep the low bits
+// as $fscanf does.
+int playback_read_text(FILE* file, uint32_t width, uint32_t* rec);
+
+class playback_writer {
+public:
+    playback_writer() : file(NULL), piped(false), binary(true), records(0) {}
+    ~playback_writer() { close(); }
+
+    // a name ending in .txt (or .txt.gz, .txt.zst) is written as text
+    bool open(const std::string& name, uint32_t input_width, uint32_t output_width);
+    // in and out are 2*playback_words() words each
+    void write(const uint32_t* in, const uint32_t* out);
+    void close();
+
+    const std::string& error() const { return err; }
+    uint64_t count() const { return records; }
+
+private:
+    void write_text(const uint32_t* vec, uint32_t width);
+
+    FILE* file;
+    bool piped;
+    bool binary;
+    playback_header hdr;
+    uint64_t records;
+    std::string err;
+    std::string line;
+};
+
+class playback_reader {
+public:
+    playback_reader();
+    ~playback_reader() { close(); }
+
+    // the widths of a text file are the expected ones, a binary file with
+    // other widths is an error
+    bool open(const std::string& name, uint32_t input_width, uint32_t output_width);
+    // copies the next record, false at the end of the stimulus. A
+    // truncated or unparsable record ends it too, error() is set then.
+    bool next(uint32_t* in, uint32_t* out);
+    void close();
+
+    // valid after open() or once next() returned false
+    const std::string& error() const { return err; }
+    bool is_binary() const { return binary; }
+    uint32_t input_width() const { return hdr.input_width; }
+    uint32_t output_width() const { return hdr.output_width; }
+    uint32_t record_words() const {
+        return 2 * (playback_words(hdr.input_width) + playback_words(hdr.output_width));
+    }
+
+private:
+    // records per block and blocks read ahead
+    static const size_t block_records = 4096;
+    static const size_t max_blocks = 8;
+
+    void prefetch();
+    bool read_record(uint32_t* rec);
+
+    FILE* file;
+    bool piped;
+    bool binary;
+    playback_header hdr;
+    std::string name;
+    std::string err;
+    uint64_t parsed;
+
+    std::thread worker;
+    std::mutex lock;
+    std::condition_variable cond;
+    std::deque<std::vector<uint32_t> > blocks;
+    bool done;
+    bool stop;
+    std::vector<uint32_t> current;
+    size_t pos;
+};
+
+#endif // PLAYBACK_IO_H
@@ -0,0 +1,85 @@
+#!/bin/bash
+# Copyright (c) 2019 Princeton University
+# All rights reserved.
+# 
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#     * Redistributions of source code must retain the above copyright
+#       notice, this list of conditions and the following disclaimer.
+#     * Redistributions in binary form must reproduce the above copyright
+#       notice, this list of conditions and the following disclaimer in the
+#       documentation and/or other materials provided with the distribution.
+#     * Neither the name of Princeton University nor the
+#       names of its contributors may be used to endorse or promote products
+#       derived from this software without specific prior written permission.
+# 
+# THIS SOFTWARE IS PROVIDED BY PRINCETON UNIVERSITY "AS IS" AND
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL PRINCETON UNIVERSITY BE LIABLE FOR ANY
+# DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# Before/after benchmark of the $bw_force_by_name entry copy of
+# tools/pli/socket/decoder.c under VCS. The "before" build uses the
+# decoder.c of the commit before the last change to it, or the file given.
+# Every build runs mra_bench.v with +calls=0 and +calls=N, one JSON line
+# per build and array shape goes to mra_bench.jsonl:
+#   {"build":"after","depth":16,"width":2,"calls":1000000,"wall_s":..,"us_per_call":..}
+#   mra_bench.sh [-n CALLS] [-s DEPTHxWIDTH]... [BEFORE_DECODER_C]
+# The default shapes are the arrays of a sparc tile: 16x2 (inq_ary of the
+# mra), 64x59 (tte_tag_ram of the 64 entry dtlb and itlb) and 64x43
+# (tte_data_ram).
+
+DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
+SOCKET="$( cd "$DIR/.." && pwd )"
+CALLS=1000000
+SHAPES=""
+while getopts "n:s:" opt; do
+    case $opt in
+        n) CALLS=$OPTARG ;;
+        s) SHAPES="$SHAPES $OPTARG" ;;
+        *) echo "usage: mra_bench.sh [-n CALLS] [-s DEPTHxWIDTH]... [BEFORE_DECODER_C]"; exit 2 ;;
+    esac
+done
+shift $((OPTIND - 1))
+SHAPES=${SHAPES:-"16x2 64x59 64x43"}
+
+WORK=$(mktemp -d mra_bench.XXXXXX)
+if [ -n "$1" ]; then
+    cp "$1" $WORK/decoder_before.c
+else
+    REV=$(git -C $SOCKET log -1 --format=%H -- decoder.c)
+    git -C $SOCKET show $REV^:./decoder.c > $WORK/decoder_before.c || exit 2
+fi
+cp $SOCKET/decoder.c $WORK/decoder_after.c
+
+now() {
+    date +%s.%N
+}
+
+: > mra_bench.jsonl
+for shape in $SHAPES; do
+    depth=${shape%x*}
+    width=${shape#*x}
+    for build in before after; do
+        simv=$WORK/simv_${build}_$shape
+        vcs -full64 +v2k +vpi -P $SOCKET/bwsocket_pli.tab -Mdir=$simv.csrc -o $simv \
+            +define+DEPTH=$depth +define+WIDTH=$width \
+            $DIR/mra_bench.v $WORK/decoder_$build.c > $simv.log 2>&1 || {
+            echo "mra_bench: the $build build failed, see $simv.log"; exit 1; }
+        t0=$(now); $simv +calls=0 > /dev/null; t1=$(now)
+        $simv +calls=$CALLS > $simv.run 2>&1; t2=$(now)
+        grep -q "mra_bench PASSED" $simv.run || {
+            echo "mra_bench: the $build build failed its check, see $simv.run"; exit 1; }
+        echo "$build $depth $width $CALLS $t0 $t1 $t2" | awk '{
+            wall = $7 - $6; base = $6 - $5;
+            printf "{\"build\":\"%s\",\"depth\":%d,\"width\":%d,\"calls\":%d,\"wall_s\":%.3f,\"us_per_call\":%.3f}\n",
+                   $1, $2, $3, $4, wall, ($4 ? (wall - base) * 1e6 / $4 : 0) }' | tee -a mra_bench.jsonl
+    done
+done
+rm -rf $WORK
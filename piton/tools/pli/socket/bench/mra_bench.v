@@ -0,0 +1,64 @@
+// Copyright (c) 2019 Princeton University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Princeton University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY PRINCETON UNIVERSITY "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL PRINCETON UNIVERSITY BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Benchmark of $bw_force_by_name(2, ...) (mra_entry() of ../decoder.c),
+// run by mra_bench.sh. +calls=N copies N entries of an array of DEPTH
+// entries of WIDTH bits, declared [DEPTH-1:0] as the mra and tlb arrays
+// are, the way sas_tasks.v reads them, and checks every copy against the
+// array.
+
+`ifndef DEPTH
+`define DEPTH 16
+`endif
+`ifndef WIDTH
+`define WIDTH 2
+`endif
+
+module mra_bench;
+
+reg [`WIDTH-1:0] ary [`DEPTH-1:0];
+reg [`WIDTH-1:0] tmp;
+integer calls, i, idx, bad;
+
+initial begin
+  if (!$value$plusargs("calls=%d", calls))
+    calls = 1000000;
+  for (i = 0; i < `DEPTH; i = i + 1)
+    ary[i] = {(`WIDTH + 31) / 32 {$random}};
+  bad = 0;
+  for (i = 0; i < calls; i = i + 1) begin
+    idx = i % `DEPTH;
+    $bw_force_by_name(2, idx, ary, tmp);
+    if (tmp !== ary[idx])
+      bad = bad + 1;
+  end
+  if (bad)
+    $display("mra_bench FAILED: %0d of %0d copies differ", bad, calls);
+  else
+    $display("mra_bench PASSED: %0d copies", calls);
+  $finish;
+end
+
+endmodule
@@ -23,13 +23,12 @@
 */
 #include "veriuser.h"
 #include "acc_user.h"
+#include "vpi_user.h"
 #ifdef __ICARUS__
 #include "icarus-compat.h"
 #endif
-// for strcat
-#include <string.h>
-// for sprintf
-#include <stdio.h>
+// for NULL
+#include <stddef.h>
 void mra_entry();
 /*-------------------------------------------------------------------------------
  dummy = $bw_decoder(30, cpu_id[2:0], rd_idx, 1, dtlb_entry_vld);
@@ -45,55 +44,59 @@ int bw_tlb_reset_vld_call()
 }
 
 /*-------------------------------------------------------------------------------
-$bw_decoder(40, `DTLBPATH0.tlb_entry_vld, cpu, 1);
+lowest declared index of the array, idx of $bw_force_by_name counts from it
+as the word offset of the old tf_nodeinfo() code did, for [15:0] and [0:15]
+alike.
+--------------------------------------------------------------------------------*/
+static int ary_low(vpiHandle ary)
+{
+   vpiHandle   range;
+   s_vpi_value value;
+   int         left, right;
+
+   value.format = vpiIntVal;
+   range = vpi_handle(vpiLeftRange, ary);
+   vpi_get_value(range, &value);
+   left  = value.value.integer;
+   vpi_free_object(range);
+   range = vpi_handle(vpiRightRange, ary);
+   vpi_get_value(range, &value);
+   right = value.value.integer;
+   vpi_free_object(range);
+   return left < right ? left : right;
+}
+
+/*-------------------------------------------------------------------------------
+$bw_force_by_name(2, idx, `TLUPATH0.mra.arr0.inq_ary0, tmp[1:0]);
+copy entry idx of the array (argument 3) into argument 4.
+the entry is moved as a vpiVectorVal, 32 bits (aval and bval) per word.
 --------------------------------------------------------------------------------*/
 void mra_entry()
 {
-   s_tfnodeinfo node_info, node_info4;
-   char *avalPtr, *bvalPtr;
-   int   groups, ind, i, num, aval[10], bval[10];
-#ifdef USE_ACC
-   s_tfexprinfo expr_info4;
-  s_setval_delay delay_s;
-  s_setval_value value_s;
-  handle tmphandle;
-  char outdata[50];
-  char tmpdata[10];
-  delay_s.model = accNoDelay;
-  outdata[0] = '\0';
-#endif
+   vpiHandle   systf, args, mode, idx, ary, entry, dst;
+   s_vpi_value value;
+
+   systf = vpi_handle(vpiSysTfCall, NULL);
+   args  = vpi_iterate(vpiArgument, systf);
+   mode  = vpi_scan(args);
+   idx   = vpi_scan(args);
+   ary   = vpi_scan(args);
+   dst   = vpi_scan(args);
+   vpi_free_object(args);
+   vpi_free_object(systf);
 
-   tf_nodeinfo(3, &node_info);
-   tf_nodeinfo(4, &node_info4);
-   avalPtr  = node_info.node_value.memoryval_p + tf_getp(2) * node_info.node_ngroups * 2;
-   bvalPtr  = avalPtr + node_info.node_ngroups;
-   groups   = 0;
-   for(ind = 0; ind < node_info4.node_ngroups; ind++){
-     aval[ind] = 0;
-     bval[ind] = 0;
-     for(i = 0; i < 4; i++){
-       num = i * 8;
-       aval[ind] |= ((avalPtr[groups] & 0xff) << num);
-       bval[ind] |= ((bvalPtr[groups] & 0xff) << num);
-       groups++;
-     }
+   entry = vpi_handle_by_index(ary, ary_low(ary) + tf_getp(2));
+   if(entry == NULL){
+     io_printf("Error: $bw_force_by_name entry %d out of range\n", tf_getp(2));
    }
-#ifdef USE_ACC
-   for(ind = node_info4.node_ngroups-1; ind >= 0; ind--){
-	sprintf(tmpdata,"%0.8x",aval[ind] & 0xffffffff);
-	strcat(outdata,tmpdata);
+   else{
+     value.format = vpiVectorVal;
+     vpi_get_value(entry, &value);
+     vpi_put_value(dst, &value, NULL, vpiNoDelay);
+     vpi_free_object(entry);
    }
-    acc_initialize();
-    tmphandle = acc_handle_tfarg(4);
-    value_s.format = accHexStrVal;
-    value_s.value.str = outdata;
-    acc_set_value(tmphandle, &value_s, &delay_s);
-#else
-   for(groups = 0; groups < node_info4.node_ngroups ; groups++){
-      node_info4.node_value.vecval_p[groups].avalbits = aval[groups] & 0xffffffff;
-      node_info4.node_value.vecval_p[groups].bvalbits = bval[groups] & 0xffffffff;
-    }
-   tf_propagatep(4);
-#endif
-
+   vpi_free_object(mode);
+   vpi_free_object(idx);
+   vpi_free_object(ary);
+   vpi_free_object(dst);
 }
@@ -48,11 +48,8 @@ int (*endofcompile_routines[])() =
     0 /*** final entry must be 0 ***/
 };
 
-extern  int read_64b_call();
-extern  int write_64b_call();
-
-extern  int init_jbus_model_call();
-extern  int iob_cdrive_call();
+/* $init_jbus_model, $iob_cdriver, $read_64b and $write_64b, see iop/iob_pli.cc */
+extern  void iob_pli_register();
 
 extern int slam_random_call();
 
@@ -67,14 +64,8 @@ s_tfcell veriusertfs[TF_MAXARRAY] =
 s_tfcell veriusertfs[] =
 #endif
 {
-    {usertask, 0, 0, 0, init_jbus_model_call, 0, "$init_jbus_model"},
-    {usertask, 0, 0, 0, iob_cdrive_call, 0, "$iob_cdriver"},
-
     {usertask, 0, 0, 0, slam_random_call, 0, "$slam_random"},
 
-    {usertask, 0, 0, 0, read_64b_call, 0, "$read_64b"},
-    {usertask, 0, 0, 0, write_64b_call, 0, "$write_64b"},
-
     {usertask, 0, 0, 0, bw_tlb_reset_vld_call, 0, "$bw_force_by_name"},
 
     {0}
@@ -84,6 +75,7 @@ s_tfcell veriusertfs[] =
 static void veriusertfs_register(void)
 {
     veriusertfs_register_table(veriusertfs);
+    iob_pli_register();
 }
 
 void (*vlog_startup_routines[])() = { &veriusertfs_register, 0 };
@@ -94,19 +86,7 @@ static void veriusertfs_register(void)
     s_vpi_systf_data task_data_s;
     p_vpi_systf_data task_data_p = &task_data_s;
 
-    //{usertask, 0, 0, 0, init_jbus_model_call, 0, "$init_jbus_model"},
-    task_data_p->type = vpiSysTask;
-    task_data_p->tfname = "$init_jbus_model";
-    task_data_p->calltf = init_jbus_model_call;
-    task_data_p->compiletf = 0;
-    vpi_register_systf(task_data_p);
-
-    //{usertask, 0, 0, 0, iob_cdrive_call, 0, "$iob_cdriver"},
-    task_data_p->type = vpiSysTask;
-    task_data_p->tfname = "$iob_cdriver";
-    task_data_p->calltf = iob_cdrive_call;
-    task_data_p->compiletf = 0;
-    vpi_register_systf(task_data_p);
+    iob_pli_register();
 
     //{usertask, 0, 0, 0, slam_random_call, 0, "$slam_random"},
     task_data_p->type = vpiSysTask;
@@ -115,20 +95,6 @@ static void veriusertfs_register(void)
     task_data_p->compiletf = 0;
     vpi_register_systf(task_data_p);
 
-    //{usertask, 0, 0, 0, read_64b_call, 0, "$read_64b"},
-    task_data_p->type = vpiSysTask;
-    task_data_p->tfname = "$read_64b";
-    task_data_p->calltf = read_64b_call;
-    task_data_p->compiletf = 0;
-    vpi_register_systf(task_data_p);
-
-    //{usertask, 0, 0, 0, write_64b_call, 0, "$write_64b"},
-    task_data_p->type = vpiSysTask;
-    task_data_p->tfname = "$write_64b";
-    task_data_p->calltf = write_64b_call;
-    task_data_p->compiletf = 0;
-    vpi_register_systf(task_data_p);
-
     //{usertask, 0, 0, 0, bw_tlb_reset_vld_call, 0, "$bw_force_by_name"},
     task_data_p->type = vpiSysTask;
     task_data_p->tfname = "$bw_force_by_name";
@@ -138,6 +104,9 @@ static void veriusertfs_register(void)
 }
 
 void (*vlog_startup_routines[])() = { &veriusertfs_register, 0 };
-
+#else
+#ifdef USE_VPI
+void (*vlog_startup_routines[])() = { &iob_pli_register, 0 };
+#endif
 #endif
 #endif
@@ -29,6 +29,9 @@
 #include "vpi_user_cds.h"
 #include "stdio.h"
 
+/* $init_jbus_model, $iob_cdriver, $read_64b and $write_64b, see iop/iob_pli.cc */
+extern void iob_pli_register();
+
 int tf_vpi()
 {
 }
@@ -49,6 +52,7 @@ register_vpi()
 void (*vlog_startup_routines[VPI_MAXARRAY])() = 
 {
   register_vpi,
+  iob_pli_register,
   0 
 };
 
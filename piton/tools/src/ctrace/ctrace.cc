@@ -0,0 +1,257 @@
+/*
+Copyright (c) 2019 Princeton University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Princeton University nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY PRINCETON UNIVERSITY "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL PRINCETON UNIVERSITY BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// ctrace, reads the commit traces written by the verilator harness
+// (sims -vlt_commit_trace, +commit_trace), see commit_trace.h.
+//
+//   ctrace dump FILE            one line per retired instruction
+//   ctrace ipc FILE [-r N]      IPC of every N instructions of each hart
+//   ctrace diff A B [-r N]      first divergence of two traces and their
+//                               IPC side by side
+//
+// Cycles are core_ref_clk cycles. N defaults to 100000.
+
+#include "commit_trace.h"
+#include <algorithm>
+#include <deque>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string>
+
+// IPC of consecutive regions of a fixed number of instructions per hart
+class ipc_regions {
+public:
+    struct region {
+        uint64_t instrs;
+        uint64_t start;
+        uint64_t end;
+    };
+    std::vector<std::vector<region> > harts;
+
+    explicit ipc_regions(uint64_t size) : size(size) {}
+
+    void add(const ct_record& rec) {
+        if (harts.size() <= rec.hart) {
+            harts.resize(rec.hart + 1);
+        }
+        std::vector<region>& r = harts[rec.hart];
+        if (r.empty() || r.back().instrs == size) {
+            region n = {0, r.empty() ? rec.cycle : r.back().end, rec.cycle};
+            r.push_back(n);
+        }
+        r.back().instrs++;
+        r.back().end = rec.cycle;
+    }
+
+    static double ipc(const region& r) {
+        return r.end > r.start ? (double) r.instrs / (r.end - r.start) : 0;
+    }
+
+private:
+    uint64_t size;
+};
+
+static void usage() {
+    fprintf(stderr, "usage: ctrace dump FILE\n"
+                    "       ctrace ipc FILE [-r INSTRS]\n"
+                    "       ctrace diff A B [-r INSTRS]\n");
+    exit(2);
+}
+
+static void open_trace(ct_reader& r, const char* name) {
+    if (!r.open(name)) {
+        fprintf(stderr, "ctrace: %s is not a commit trace\n", name);
+        exit(2);
+    }
+}
+
+static void print_record(const char* prefix, const ct_record& rec) {
+    printf("%s%" PRIu64 " hart %u pc %016" PRIx64, prefix, rec.cycle, rec.hart, rec.pc);
+    if (rec.flags & CT_NOINSTR) {
+        printf(" instr ?");
+    } else {
+        printf(" instr %0*x", rec.instr > 0xffff ? 8 : 4, rec.instr);
+    }
+    if (rec.flags & CT_RD) {
+        printf(" x%u=%016" PRIx64, rec.rd, rec.rd_data);
+    }
+    if (rec.flags & CT_ADDR) {
+        printf(" addr %016" PRIx64, rec.addr);
+    }
+    printf("\n");
+}
+
+static bool same(const ct_record& a, const ct_record& b) {
+    return a.pc == b.pc && a.instr == b.instr && a.flags == b.flags && a.rd == b.rd &&
+           a.rd_data == b.rd_data && a.addr == b.addr;
+}
+
+static int dump(const char* name) {
+    ct_reader r;
+    ct_record rec;
+    open_trace(r, name);
+    while (r.next(rec)) {
+        print_record("", rec);
+    }
+    return 0;
+}
+
+static void print_ipc(const std::vector<const ipc_regions*>& runs) {
+    size_t harts = 0;
+    for (size_t i = 0; i < runs.size(); i++) {
+        harts = std::max(harts, runs[i]->harts.size());
+    }
+    for (size_t h = 0; h < harts; h++) {
+        size_t regions = 0;
+        for (size_t i = 0; i < runs.size(); i++) {
+            if (h < runs[i]->harts.size()) {
+                regions = std::max(regions, runs[i]->harts[h].size());
+            }
+        }
+        for (size_t n = 0; n < regions; n++) {
+            printf("hart %zu region %zu", h, n);
+            for (size_t i = 0; i < runs.size(); i++) {
+                if (h < runs[i]->harts.size() && n < runs[i]->harts[h].size()) {
+                    const ipc_regions::region& r = runs[i]->harts[h][n];
+                    printf("  %8" PRIu64 " instrs %10" PRIu64 " cycles ipc %.3f", r.instrs,
+                           r.end - r.start, ipc_regions::ipc(r));
+                } else {
+                    printf("  %46s", "-");
+                }
+            }
+            printf("\n");
+        }
+    }
+}
+
+static int ipc(const char* name, uint64_t size) {
+    ct_reader r;
+    ct_record rec;
+    ipc_regions regions(size);
+    open_trace(r, name);
+    while (r.next(rec)) {
+        regions.add(rec);
+    }
+    print_ipc(std::vector<const ipc_regions*>(1, &regions));
+    return 0;
+}
+
+// Records are matched per hart in commit order, the interleaving of the
+// harts may differ between the two runs.
+static int diff(const char* name_a, const char* name_b, uint64_t size) {
+    ct_reader r[2];
+    ipc_regions regions[2] = {ipc_regions(size), ipc_regions(size)};
+    std::vector<std::deque<ct_record> > pending[2];
+    std::vector<uint64_t> count;
+    bool more[2] = {true, true};
+    bool diverged = false;
+    open_trace(r[0], name_a);
+    open_trace(r[1], name_b);
+
+    while (more[0] || more[1]) {
+        for (int i = 0; i < 2; i++) {
+            ct_record rec;
+            if (!more[i] || !(more[i] = r[i].next(rec))) {
+                continue;
+            }
+            regions[i].add(rec);
+            if (diverged) {
+                continue;
+            }
+            if (pending[i].size() <= rec.hart) {
+                pending[0].resize(rec.hart + 1);
+                pending[1].resize(rec.hart + 1);
+                count.resize(rec.hart + 1);
+            }
+            std::deque<ct_record>& other = pending[i ^ 1][rec.hart];
+            if (other.empty()) {
+                pending[i][rec.hart].push_back(rec);
+                continue;
+            }
+            const ct_record& a = i ? other.front() : rec;
+            const ct_record& b = i ? rec : other.front();
+            if (!same(a, b)) {
+                printf("first divergence at instruction %" PRIu64 " of hart %u\n", count[rec.hart],
+                       rec.hart);
+                print_record("  A: ", a);
+                print_record("  B: ", b);
+                diverged = true;
+            }
+            count[rec.hart]++;
+            other.pop_front();
+        }
+    }
+    // one trace ended early
+    for (size_t h = 0; !diverged && h < count.size(); h++) {
+        for (int i = 0; i < 2; i++) {
+            if (!pending[i][h].empty()) {
+                printf("hart %zu: %s ends after %" PRIu64 " instructions, %s continues with\n", h,
+                       i ? name_a : name_b, count[h], i ? name_b : name_a);
+                print_record(i ? "  B: " : "  A: ", pending[i][h].front());
+                diverged = true;
+                break;
+            }
+        }
+    }
+    if (!diverged) {
+        printf("no divergence\n");
+    }
+    std::vector<const ipc_regions*> runs;
+    runs.push_back(&regions[0]);
+    runs.push_back(&regions[1]);
+    printf("IPC per %" PRIu64 " instructions, A then B\n", size);
+    print_ipc(runs);
+    return diverged ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    uint64_t size = 100000;
+    std::vector<char*> files;
+    if (argc < 3) {
+        usage();
+    }
+    for (int i = 2; i < argc; i++) {
+        if (!strcmp(argv[i], "-r") && i + 1 < argc) {
+            size = strtoull(argv[++i], NULL, 0);
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+    if (!size) {
+        usage();
+    }
+    std::string cmd = argv[1];
+    if (cmd == "dump" && files.size() == 1) {
+        return dump(files[0]);
+    } else if (cmd == "ipc" && files.size() == 1) {
+        return ipc(files[0], size);
+    } else if (cmd == "diff" && files.size() == 2) {
+        return diff(files[0], files[1], size);
+    }
+    usage();
+    return 2;
+}
@@ -0,0 +1,312 @@
+/*
+Copyright (c) 2019 Princeton University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Princeton University nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY PRINCETON UNIVERSITY "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL PRINCETON UNIVERSITY BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// evlog_dec, prints the binary event log of the monitors (sims -evlog,
+// see tools/pli/evlog/evlog.h) as the text they would have printed with
+// $display and $write.
+//
+//   evlog_dec [-s SOURCE] [-b TIME] [-e TIME] [-r] FILE
+//
+// -s keeps the events of the named monitor (cmp_l15_messages_mon, l2_mon,
+// lsu_mon2, tlu_mon), -b and -e the records from and up to a simulation
+// time. -r prints a line per record, the time, the source and the event
+// and the fields in hex, instead of the text. The formats follow the
+// simulator, values print unsigned and %t as %d.
+
+#include "evlog.h"
+#include <ctype.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <set>
+
+struct field {
+    const std::vector<uint32_t>& aval;
+    const std::vector<uint32_t>& bval;
+    uint32_t width;
+
+    field(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b, uint32_t w)
+        : aval(a), bval(b), width(w < EVLOG_MAX_WIDTH ? w : EVLOG_MAX_WIDTH) {}
+
+    // 0, 1, 'x' or 'z'
+    int bit(uint32_t i) const {
+        int a = aval[i / 32] >> (i % 32) & 1;
+        int b = bval[i / 32] >> (i % 32) & 1;
+        return b ? (a ? 'x' : 'z') : a;
+    }
+};
+
+static void usage() {
+    fprintf(stderr, "usage: evlog_dec [-s SOURCE] [-b TIME] [-e TIME] [-r] FILE\n");
+    exit(2);
+}
+
+// the digit of unknown bits, x and z for all of them, X and Z for some
+static char unknown(int xs, int zs, int bits) {
+    if (xs) {
+        return xs == bits ? 'x' : 'X';
+    }
+    return zs == bits ? 'z' : 'Z';
+}
+
+static std::string radix(const field& f, int shift) {
+    static const char digits[] = "0123456789abcdef";
+    std::string s;
+    int n = (f.width + shift - 1) / shift;
+    for (int d = n - 1; d >= 0; d--) {
+        int value = 0, xs = 0, zs = 0, bits = 0;
+        for (int i = shift - 1; i >= 0; i--) {
+            uint32_t b = d * shift + i;
+            if (b >= f.width) {
+                continue;
+            }
+            int v = f.bit(b);
+            bits++;
+            xs += v == 'x';
+            zs += v == 'z';
+            value = value << 1 | (v == 1);
+        }
+        s += xs || zs ? unknown(xs, zs, bits) : digits[value];
+    }
+    return s;
+}
+
+static std::string decimal(const field& f) {
+    int xs = 0, zs = 0;
+    for (uint32_t i = 0; i < f.width; i++) {
+        int v = f.bit(i);
+        xs += v == 'x';
+        zs += v == 'z';
+    }
+    if (xs || zs) {
+        return std::string(1, unknown(xs, zs, f.width));
+    }
+    // long division by 10^9 of the words, most significant first
+    std::vector<uint32_t> words(f.aval.begin(), f.aval.begin() + evlog_words(f.width));
+    std::string s;
+    for (;;) {
+        uint64_t rem = 0;
+        bool zero = true;
+        for (size_t w = words.size(); w-- > 0;) {
+            uint64_t cur = rem << 32 | words[w];
+            words[w] = cur / 1000000000;
+            rem = cur % 1000000000;
+            zero = zero && !words[w];
+        }
+        char part[16];
+        snprintf(part, sizeof(part), zero ? "%u" : "%09u", (unsigned) rem);
+        s = part + s;
+        if (zero) {
+            return s;
+        }
+    }
+}
+
+// the width of %d, the digits of the largest value of the field
+static size_t decimal_width(uint32_t width) {
+    static std::map<uint32_t, size_t> widths;
+    std::map<uint32_t, size_t>::iterator it = widths.find(width);
+    if (it != widths.end()) {
+        return it->second;
+    }
+    std::vector<uint32_t> ones(evlog_words(width), ~0u), none(ones.size(), 0);
+    if (width % 32) {
+        ones.back() = (1u << (width % 32)) - 1;
+    }
+    size_t n = decimal(field(ones, none, width)).size();
+    widths[width] = n;
+    return n;
+}
+
+static std::string strip_zeros(const std::string& s) {
+    size_t i = s.find_first_not_of('0');
+    return i == std::string::npos ? "0" : s.substr(i);
+}
+
+static std::string text(const field& f, bool minimal) {
+    std::string s;
+    bool leading = true;
+    for (int byte = (f.width + 7) / 8 - 1; byte >= 0; byte--) {
+        int c = 0;
+        for (int i = 7; i >= 0; i--) {
+            uint32_t b = byte * 8 + i;
+            c = c << 1 | (b < f.width && f.bit(b) == 1);
+        }
+        if (c == 0 && leading) {
+            if (!minimal) {
+                s += ' ';
+            }
+            continue;
+        }
+        leading = false;
+        s += (char) c;
+    }
+    return s;
+}
+
+static void pad(std::string& out, const std::string& s, size_t width, bool left, char fill) {
+    if (left) {
+        out += s;
+    }
+    if (s.size() < width) {
+        out.append(width - s.size(), fill);
+    }
+    if (!left) {
+        out += s;
+    }
+}
+
+// $display formatting of a record, the conversions the rewrite keeps
+static std::string format(const std::string& fmt, const evlog_item& rec) {
+    std::string out;
+    size_t arg = 0;
+    for (size_t i = 0; i < fmt.size(); i++) {
+        if (fmt[i] != '%' || i + 1 == fmt.size()) {
+            out += fmt[i];
+            continue;
+        }
+        size_t start = i++;
+        bool left = false, zero = false, sized = false;
+        size_t width = 0;
+        if (fmt[i] == '-') {
+            left = true;
+            i++;
+        }
+        if (i < fmt.size() && fmt[i] == '0' && i + 1 < fmt.size() && isdigit(fmt[i + 1])) {
+            zero = true;
+            i++;
+        }
+        while (i < fmt.size() && isdigit(fmt[i])) {
+            width = width * 10 + (fmt[i++] - '0');
+            sized = true;
+        }
+        char c = i < fmt.size() ? tolower(fmt[i]) : 0;
+        if (c == '%') {
+            out += '%';
+            continue;
+        }
+        if (!strchr("bodhxcst", c) || !c || arg >= rec.widths.size()) {
+            out.append(fmt, start, i - start + 1);
+            continue;
+        }
+        field f(rec.aval[arg], rec.bval[arg], rec.widths[arg]);
+        arg++;
+        std::string s;
+        switch (c) {
+        case 'b':
+        case 'o':
+        case 'h':
+        case 'x':
+            s = radix(f, c == 'b' ? 1 : c == 'o' ? 3 : 4);
+            if (sized) {
+                s = strip_zeros(s);
+            }
+            pad(out, s, width, left, '0');
+            break;
+        case 'd':
+        case 't':
+            s = decimal(f);
+            pad(out, s, sized ? width : c == 't' ? 20 : decimal_width(f.width), left,
+                zero ? '0' : ' ');
+            break;
+        case 'c':
+            out += (char) (f.aval[0] & 0xff);
+            break;
+        case 's':
+            s = text(f, sized && !width);
+            pad(out, s, width, left, ' ');
+            break;
+        }
+    }
+    return out;
+}
+
+static std::string raw(const evlog_item& rec, const std::string& source) {
+    char head[64];
+    snprintf(head, sizeof(head), "%" PRIu64 " %s.%u", rec.time, source.c_str(),
+             evlog_event_of(rec.site));
+    std::string out = head;
+    for (size_t i = 0; i < rec.widths.size(); i++) {
+        field f(rec.aval[i], rec.bval[i], rec.widths[i]);
+        out += " " + strip_zeros(radix(f, 4));
+    }
+    return out + "\n";
+}
+
+int main(int argc, char** argv) {
+    std::set<std::string> only;
+    uint64_t begin = 0, end = ~0ull;
+    bool raw_records = false;
+    const char* name = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-s") && i + 1 < argc) {
+            only.insert(argv[++i]);
+        } else if (!strcmp(argv[i], "-b") && i + 1 < argc) {
+            begin = strtoull(argv[++i], NULL, 0);
+        } else if (!strcmp(argv[i], "-e") && i + 1 < argc) {
+            end = strtoull(argv[++i], NULL, 0);
+        } else if (!strcmp(argv[i], "-r")) {
+            raw_records = true;
+        } else if (argv[i][0] != '-' && !name) {
+            name = argv[i];
+        } else {
+            usage();
+        }
+    }
+    if (!name) {
+        usage();
+    }
+
+    evlog_reader r;
+    evlog_item item;
+    std::map<uint32_t, std::string> sources;
+    std::map<uint32_t, std::string> formats;
+    if (!r.open(name)) {
+        fprintf(stderr, "evlog_dec: %s\n", r.error().c_str());
+        return 2;
+    }
+    while (r.next(item)) {
+        if (item.kind == EVLOG_SOURCE) {
+            sources[item.source] = item.text;
+        } else if (item.kind == EVLOG_EVENT) {
+            formats[item.site] = item.text;
+        } else if (item.time >= begin && item.time <= end) {
+            const std::string& source = sources[evlog_source_of(item.site)];
+            if (!only.empty() && !only.count(source)) {
+                continue;
+            }
+            std::string s = raw_records ? raw(item, source) : format(formats[item.site], item);
+            fwrite(s.data(), 1, s.size(), stdout);
+        }
+    }
+    if (!r.error().empty()) {
+        fprintf(stderr, "evlog_dec: %s: %s\n", name, r.error().c_str());
+        return 1;
+    }
+    return 0;
+}
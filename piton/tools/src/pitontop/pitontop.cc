@@ -0,0 +1,261 @@
+/*
+Copyright (c) 2019 Princeton University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Princeton University nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY PRINCETON UNIVERSITY "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL PRINCETON UNIVERSITY BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// pitontop, shows the live statistics of the verilator simulations running
+// on this machine (see tools/verilator/live_stats.h).
+//
+//   pitontop [-d SECS] [-n COUNT]        one line per simulation
+//   pitontop [-d SECS] [-n COUNT] PID    cores and NoC planes of one
+//
+// The screen is refreshed every SECS seconds (default 2) until COUNT
+// refreshes (default 0, forever) or ^C. Rates and IPC are over the last
+// refresh. A simulation whose cycle did not move is shown as "stall", one
+// that simulates without retiring instructions as "noret". Segments of
+// processes that no longer exist are removed.
+
+#include "live_stats.h"
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <map>
+#include <string>
+#include <vector>
+
+struct sim_view {
+    live_segment seg;
+    double time;             // when the copy was taken
+};
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// consistent copy of the segment called name, false when it is gone, not
+// a live statistics segment or left by a dead process
+static bool read_segment(const std::string& name, sim_view& view) {
+    std::string path = "/" + name;
+    int fd = shm_open(path.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        return false;
+    }
+    void* p = mmap(NULL, sizeof(live_segment), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        return false;
+    }
+    const live_segment* seg = (const live_segment*) p;
+    bool ok = false;
+    for (int tries = 0; tries < 1000 && !ok; tries++) {
+        uint32_t seq = seg->seq;
+        if (seq & 1) {
+            continue;
+        }
+        __sync_synchronize();
+        memcpy(&view.seg, (const void*) seg, sizeof(live_segment));
+        __sync_synchronize();
+        ok = seg->seq == seq;
+    }
+    munmap(p, sizeof(live_segment));
+    view.time = now();
+    if (!ok || view.seg.magic != LIVE_MAGIC || view.seg.version != LIVE_VERSION) {
+        return false;
+    }
+    if (kill(view.seg.pid, 0) && errno == ESRCH) {
+        shm_unlink(path.c_str());
+        return false;
+    }
+    view.seg.dir[sizeof(view.seg.dir) - 1] = '\0';
+    view.seg.phase[sizeof(view.seg.phase) - 1] = '\0';
+    return true;
+}
+
+static std::vector<sim_view> read_all(int pid) {
+    std::vector<sim_view> views;
+    DIR* dir = opendir("/dev/shm");
+    if (!dir) {
+        return views;
+    }
+    while (struct dirent* ent = readdir(dir)) {
+        std::string name = ent->d_name;
+        sim_view view;
+        if (name.compare(0, strlen(LIVE_PREFIX), LIVE_PREFIX) ||
+            (pid && atoi(name.c_str() + strlen(LIVE_PREFIX)) != pid) ||
+            !read_segment(name, view)) {
+            continue;
+        }
+        views.push_back(view);
+    }
+    closedir(dir);
+    return views;
+}
+
+static uint64_t retired(const live_segment& seg) {
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < seg.cores && i < LIVE_MAX_CORES; i++) {
+        sum += seg.retired[i];
+    }
+    return sum;
+}
+
+static uint64_t flits(const live_segment& seg) {
+    uint64_t sum = 0;
+    for (int p = 0; p < LIVE_PLANES; p++) {
+        sum += seg.flits[p][LIVE_TO_CHIPSET] + seg.flits[p][LIVE_TO_CHIP];
+    }
+    return sum;
+}
+
+static const char* state(const sim_view& cur, const sim_view* last) {
+    static const char* status[] = { "pass", "fail", "timeout", "deadlock" };
+    if (cur.seg.status >= 0) {
+        return cur.seg.status < 4 ? status[cur.seg.status] : "fail";
+    }
+    if (!last || last->seg.start != cur.seg.start) {
+        return "run";
+    }
+    if (cur.seg.cycle == last->seg.cycle) {
+        return "stall";
+    }
+    if (!strcmp(cur.seg.phase, "workload") && retired(cur.seg) == retired(last->seg)) {
+        return "noret";
+    }
+    return "run";
+}
+
+static double ratio(uint64_t num, uint64_t den) {
+    return den ? (double) num / den : 0;
+}
+
+static void show_all(const std::vector<sim_view>& views, const std::map<int, sim_view>& last) {
+    printf("%7s %-8s %-10s %14s %9s %14s %6s %9s %12s %12s %8s  %s\n",
+           "PID", "STATE", "PHASE", "CYCLE", "KCYC/S", "INSTRS", "IPC",
+           "FLITS/KC", "MEM READS", "MEM WRITES", "WALL", "DIR");
+    for (size_t i = 0; i < views.size(); i++) {
+        const live_segment& s = views[i].seg;
+        std::map<int, sim_view>::const_iterator it = last.find(s.pid);
+        const sim_view* l = it == last.end() ? NULL : &it->second;
+        bool delta = l && l->seg.start == s.start && s.cycle > l->seg.cycle;
+        uint64_t cycles = delta ? s.cycle - l->seg.cycle : s.cycle;
+        uint64_t instrs = retired(s) - (delta ? retired(l->seg) : 0);
+        uint64_t nflits = flits(s) - (delta ? flits(l->seg) : 0);
+        printf("%7d %-8s %-10.10s %14" PRIu64 " %9.2f %14" PRIu64 " %6.3f %9.1f %12" PRIu64
+               " %12" PRIu64 " %8.0f  %s\n",
+               s.pid, state(views[i], l), s.phase, s.cycle, s.cycles_per_s / 1000,
+               retired(s), ratio(instrs, cycles), 1000 * ratio(nflits, cycles),
+               s.mem_reads, s.mem_writes, s.wall_s, s.dir);
+    }
+    if (views.empty()) {
+        printf("no simulations running\n");
+    }
+}
+
+static void show_one(const sim_view& view, const sim_view* l) {
+    const live_segment& s = view.seg;
+    bool delta = l && l->seg.start == s.start && s.cycle > l->seg.cycle;
+    uint64_t cycles = delta ? s.cycle - l->seg.cycle : s.cycle;
+    printf("pid %d  %s  phase %s  cycle %" PRIu64 "  %.0f cycles/s  wall %.0f s\n%s\n\n",
+           s.pid, state(view, l), s.phase, s.cycle, s.cycles_per_s, s.wall_s, s.dir);
+
+    printf("%5s %14s %7s\n", "CORE", "INSTRS", "IPC");
+    for (uint32_t i = 0; i < s.cores && i < LIVE_MAX_CORES; i++) {
+        uint64_t instrs = s.retired[i] - (delta ? l->seg.retired[i] : 0);
+        printf("%5u %14" PRIu64 " %7.3f\n", i, s.retired[i], ratio(instrs, cycles));
+    }
+
+    printf("\n%5s %14s %14s %10s %10s\n", "NOC", "TO CHIPSET", "TO CHIP", "/KC OUT", "/KC IN");
+    for (int p = 0; p < LIVE_PLANES; p++) {
+        uint64_t out = s.flits[p][LIVE_TO_CHIPSET] - (delta ? l->seg.flits[p][LIVE_TO_CHIPSET] : 0);
+        uint64_t in = s.flits[p][LIVE_TO_CHIP] - (delta ? l->seg.flits[p][LIVE_TO_CHIP] : 0);
+        printf("%5d %14" PRIu64 " %14" PRIu64 " %10.1f %10.1f\n", p + 1,
+               s.flits[p][LIVE_TO_CHIPSET], s.flits[p][LIVE_TO_CHIP],
+               1000 * ratio(out, cycles), 1000 * ratio(in, cycles));
+    }
+    printf("\nmemory reads %" PRIu64 ", writes %" PRIu64 "\n", s.mem_reads, s.mem_writes);
+}
+
+static void usage() {
+    fprintf(stderr, "usage: pitontop [-d SECS] [-n COUNT] [PID]\n");
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    double delay = 2;
+    long count = 0;
+    int pid = 0;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-d") && i + 1 < argc) {
+            delay = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+            count = atol(argv[++i]);
+        } else if (argv[i][0] != '-' && !pid) {
+            pid = atoi(argv[i]);
+        } else {
+            usage();
+        }
+    }
+    if (delay <= 0 || count < 0 || pid < 0) {
+        usage();
+    }
+
+    bool tty = isatty(fileno(stdout));
+    std::map<int, sim_view> last;
+    for (long n = 0; !count || n < count; n++) {
+        if (n) {
+            usleep((useconds_t) (delay * 1e6));
+        }
+        std::vector<sim_view> views = read_all(pid);
+        if (tty) {
+            printf("\033[H\033[2J");
+        }
+        if (pid) {
+            if (views.empty()) {
+                printf("no simulation with pid %d\n", pid);
+                return 1;
+            }
+            std::map<int, sim_view>::const_iterator it = last.find(pid);
+            show_one(views[0], it == last.end() ? NULL : &it->second);
+        } else {
+            show_all(views, last);
+        }
+        fflush(stdout);
+        last.clear();
+        for (size_t i = 0; i < views.size(); i++) {
+            last[views[i].seg.pid] = views[i];
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,103 @@
+/*
+Copyright (c) 2019 Princeton University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Princeton University nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY PRINCETON UNIVERSITY "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL PRINCETON UNIVERSITY BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// playback_conv, converts stimulus files of the playback environments
+// between the text and binary formats of tools/pli/playback/playback_io.h.
+//
+//   playback_conv [-i IN_WIDTH -o OUT_WIDTH] FROM TO
+//
+// A text FROM needs the widths of its input and output vectors (the
+// inputwidth and outputwidth parameters of the playback driver), a binary
+// one has them in its header. TO is written as text when its name ends in
+// .txt, binary otherwise, compressed when it ends in .gz or .zst.
+//   playback_conv -i 361 -o 331 stimuli.txt stimuli.pbv.zst
+
+#include "playback_io.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+static void usage() {
+    fprintf(stderr, "usage: playback_conv [-i IN_WIDTH -o OUT_WIDTH] FROM TO\n");
+    exit(2);
+}
+
+static long long file_size(const char* name) {
+    struct stat st;
+    return stat(name, &st) == 0 ? (long long) st.st_size : -1;
+}
+
+int main(int argc, char** argv) {
+    uint32_t input_width = 0, output_width = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "i:o:")) != -1) {
+        switch (opt) {
+        case 'i': input_width = atoi(optarg); break;
+        case 'o': output_width = atoi(optarg); break;
+        default: usage();
+        }
+    }
+    if (argc - optind != 2) {
+        usage();
+    }
+    const char* from = argv[optind];
+    const char* to = argv[optind + 1];
+
+    playback_reader reader;
+    if (!reader.open(from, input_width, output_width)) {
+        fprintf(stderr, "playback_conv: %s\n", reader.error().c_str());
+        return 1;
+    }
+    if (!reader.input_width() || !reader.output_width()) {
+        fprintf(stderr, "playback_conv: the widths of text stimulus %s are needed, -i and -o\n", from);
+        return 2;
+    }
+    playback_writer writer;
+    if (!writer.open(to, reader.input_width(), reader.output_width())) {
+        fprintf(stderr, "playback_conv: %s\n", writer.error().c_str());
+        return 1;
+    }
+
+    std::vector<uint32_t> in(2 * playback_words(reader.input_width()));
+    std::vector<uint32_t> out(2 * playback_words(reader.output_width()));
+    while (reader.next(&in[0], &out[0])) {
+        writer.write(&in[0], &out[0]);
+    }
+    reader.close();
+    writer.close();
+    if (!reader.error().empty()) {
+        fprintf(stderr, "playback_conv: %s, %s is incomplete\n", reader.error().c_str(), to);
+        return 1;
+    }
+
+    printf("%s: %llu records of %u/%u bits, %lld -> %lld bytes\n", to,
+           (unsigned long long) writer.count(), reader.input_width(), reader.output_width(),
+           file_size(from), file_size(to));
+    return 0;
+}
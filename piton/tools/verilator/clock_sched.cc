@@ -0,0 +1,160 @@
+/*
+Copyright (c) 2019 Princeton University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Princeton University nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY PRINCETON UNIVERSITY "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL PRINCETON UNIVERSITY BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "clock_sched.h"
+
+void clock_sched::clear(uint64_t t) {
+    dom.clear();
+    queue = std::priority_queue<clock_event, std::vector<clock_event>, std::greater<clock_event> >();
+    now = t;
+    steps = 0;
+    last_rose = last_fell = 0;
+}
+
+int clock_sched::add(const char* name, CData* sig, uint64_t period, uint64_t phase) {
+    clock_domain d;
+    d.name = name;
+    d.sig = sig;
+    d.period = period < 2 ? 2 : period;
+    d.phase = now + (phase ? phase : d.period / 2);
+    d.edge = 0;
+    d.rising = 0;
+    d.gen = 0;
+    d.gated = false;
+    d.queued = false;
+    *sig = 0;
+    dom.push_back(d);
+    schedule(dom.size() - 1);
+    return dom.size() - 1;
+}
+
+int clock_sched::find(const char* name) const {
+    for (size_t i = 0; i < dom.size(); i++) {
+        if (dom[i].name == name) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void clock_sched::gate(int domain, bool off) {
+    clock_domain& d = dom[domain];
+    d.gated = off;
+    if (off && !*d.sig && d.queued) {
+        // the queued rising edge goes stale
+        d.gen++;
+        d.queued = false;
+    } else if (!off && !d.queued) {
+        first_edge_after(d, now, true);
+        schedule(domain);
+    }
+}
+
+uint64_t clock_sched::step() {
+    last_rose = last_fell = 0;
+    while (!queue.empty() && queue.top().gen != dom[queue.top().domain].gen) {
+        queue.pop();
+    }
+    if (queue.empty()) {
+        return now;
+    }
+    now = queue.top().time;
+    while (!queue.empty() && queue.top().time == now) {
+        clock_event e = queue.top();
+        queue.pop();
+        clock_domain& d = dom[e.domain];
+        if (e.gen != d.gen) {
+            continue;
+        }
+        *d.sig = !*d.sig;
+        if (*d.sig) {
+            last_rose |= 1ULL << e.domain;
+            d.rising++;
+        } else {
+            last_fell |= 1ULL << e.domain;
+        }
+        d.edge++;
+        d.queued = false;
+        if (!d.gated || *d.sig) {
+            schedule(e.domain);
+        }
+    }
+    steps++;
+    return now;
+}
+
+void clock_sched::skip(uint64_t dt) {
+    for (size_t i = 0; i < dom.size(); i++) {
+        dom[i].phase += dt;
+    }
+    resync(now + dt);
+}
+
+void clock_sched::resync(uint64_t t) {
+    queue = std::priority_queue<clock_event, std::vector<clock_event>, std::greater<clock_event> >();
+    now = t;
+    for (size_t i = 0; i < dom.size(); i++) {
+        clock_domain& d = dom[i];
+        d.gen++;
+        d.queued = false;
+        if (d.gated && !*d.sig) {
+            continue;
+        }
+        first_edge_after(d, t, !*d.sig);
+        schedule(i);
+    }
+}
+
+void clock_sched::report(std::ostream& os) const {
+    for (size_t i = 0; i < dom.size(); i++) {
+        os << "clock " << dom[i].name << ": period " << dom[i].period << ", "
+           << dom[i].rising << " rising edges" << (dom[i].gated ? ", gated" : "") << std::endl;
+    }
+    os << "clock scheduler: " << steps << " edge times evaluated" << std::endl;
+}
+
+void clock_sched::schedule(int domain) {
+    clock_domain& d = dom[domain];
+    clock_event e;
+    e.time = edge_time(d, d.edge);
+    e.domain = domain;
+    e.gen = d.gen;
+    queue.push(e);
+    d.queued = true;
+}
+
+// the first rising (even) or falling (odd) edge after t
+void clock_sched::first_edge_after(clock_domain& d, uint64_t t, bool rising) {
+    uint64_t edge = t < d.phase ? 0 : 2 * (t - d.phase) / d.period;
+    while (edge_time(d, edge) <= t) {
+        edge++;
+    }
+    if ((edge & 1) != !rising) {
+        edge++;
+    }
+    d.edge = edge;
+}
@@ -0,0 +1,126 @@
+/*
+Copyright (c) 2019 Princeton University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Princeton University nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY PRINCETON UNIVERSITY "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL PRINCETON UNIVERSITY BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Event driven clock scheduler of the Verilator harnesses.
+//
+// Every clock domain is a top port with its own period and phase. The
+// pending edges of all domains are kept in a priority queue, step() jumps
+// to the earliest one and toggles every clock that has an edge at that
+// time, so the model is evaluated once per distinct edge time and not for
+// a fixed time step. Edge k of a domain is at phase + k * period / 2,
+// the even ones rising, which keeps odd periods exact.
+//
+// A domain can be gated off: a low clock stays low, a high one still
+// falls at its next edge and then stops. Ungating resumes with the next
+// rising edge of the original period and phase. Domain 0 is the main
+// clock the caller counts cycles on, it must not be gated. Up to 64
+// domains.
+
+#ifndef CLOCK_SCHED_H
+#define CLOCK_SCHED_H
+
+#include "verilated.h"
+#include <ostream>
+#include <queue>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+struct clock_domain {
+    std::string name;
+    CData* sig;
+    uint64_t period;
+    uint64_t phase;     // time of the first rising edge
+    uint64_t edge;      // number of the next edge
+    uint64_t rising;    // rising edges so far
+    unsigned gen;       // queued edges of older generations are stale
+    bool gated;
+    bool queued;
+};
+
+class clock_sched {
+public:
+    clock_sched() : now(0), steps(0), last_rose(0), last_fell(0) {}
+
+    // drop all domains and restart at time t, for a new model
+    void clear(uint64_t t = 0);
+    // the clock starts low, phase 0 puts the first rising edge half a
+    // period from now. Returns the domain number.
+    int add(const char* name, CData* sig, uint64_t period, uint64_t phase = 0);
+    // domain number of name, -1 when there is none
+    int find(const char* name) const;
+    void gate(int domain, bool off);
+
+    // advance to the next edge and return its time
+    uint64_t step();
+    // the domain had an edge in the last step()
+    bool rose(int domain) const {
+        return last_rose >> domain & 1;
+    }
+    bool fell(int domain) const {
+        return last_fell >> domain & 1;
+    }
+
+    // move the schedule forward by dt without any edges, the clocks keep
+    // their levels
+    void skip(uint64_t dt);
+    // rebuild the queue at time t from the current levels of the clocks,
+    // after a checkpoint was restored
+    void resync(uint64_t t);
+
+    // one line per domain with its period and rising edges, and the evals
+    void report(std::ostream& os) const;
+
+    const std::vector<clock_domain>& domains() const {
+        return dom;
+    }
+
+private:
+    struct clock_event {
+        uint64_t time;
+        int domain;
+        unsigned gen;
+        bool operator>(const clock_event& o) const {
+            return time > o.time;
+        }
+    };
+
+    std::vector<clock_domain> dom;
+    std::priority_queue<clock_event, std::vector<clock_event>, std::greater<clock_event> > queue;
+    uint64_t now;
+    uint64_t steps;
+    uint64_t last_rose;
+    uint64_t last_fell;
+
+    uint64_t edge_time(const clock_domain& d, uint64_t edge) const {
+        return d.phase + edge * d.period / 2;
+    }
+    void schedule(int domain);
+    void first_edge_after(clock_domain& d, uint64_t t, bool rising);
+};
+
+#endif
@@ -0,0 +1,234 @@
+/*
+Copyright (c) 2019 Princeton University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Princeton University nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY PRINCETON UNIVERSITY "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL PRINCETON UNIVERSITY BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "commit_trace.h"
+#include "verilated.h"
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+extern double sc_time_stamp();
+
+namespace {
+
+// records are collected in one buffer while the writer thread writes
+// the other one
+const size_t buffer_size = 1 << 20;
+
+bool trace_on = false;
+FILE* trace_fp = NULL;
+std::vector<uint8_t> bufs[2];
+int fill = 0;
+bool pending = false;
+bool done = false;
+std::mutex mtx;
+std::condition_variable cv;
+std::thread writer;
+
+uint64_t last_cycle = 0;
+std::vector<ct_hart> harts;
+
+// What the pipeline of a hart said about its instructions before they
+// commit, per scoreboard entry (trans_id): the instruction from decode and
+// the address from the LSU. Instructions in flight when the trace state
+// started (after a restore) have neither, they get CT_NOINSTR.
+struct ct_pipe {
+    std::deque<uint32_t> decoded;   // decoded, not issued yet
+    std::vector<uint32_t> instr;
+    std::vector<uint8_t> instr_ok;
+    std::vector<uint64_t> addr;
+    std::vector<uint8_t> addr_ok;
+};
+std::vector<ct_pipe> pipes;
+
+ct_pipe& pipe(int hart, int id) {
+    if (pipes.size() <= (size_t) hart) {
+        pipes.resize(hart + 1);
+    }
+    ct_pipe& p = pipes[hart];
+    if (p.instr.size() <= (size_t) id) {
+        p.instr.resize(id + 1);
+        p.instr_ok.resize(id + 1);
+        p.addr.resize(id + 1);
+        p.addr_ok.resize(id + 1);
+    }
+    return p;
+}
+
+void writer_main() {
+    std::unique_lock<std::mutex> lock(mtx);
+    while (true) {
+        cv.wait(lock, [] { return pending || done; });
+        if (!pending) {
+            break;
+        }
+        std::vector<uint8_t>& buf = bufs[fill ^ 1];
+        lock.unlock();
+        fwrite(buf.data(), 1, buf.size(), trace_fp);
+        buf.clear();
+        lock.lock();
+        pending = false;
+        cv.notify_all();
+    }
+}
+
+// hand the full buffer to the writer, waits while it is still busy with
+// the previous one
+void swap_buffers() {
+    std::unique_lock<std::mutex> lock(mtx);
+    cv.wait(lock, [] { return !pending; });
+    fill ^= 1;
+    pending = true;
+    cv.notify_all();
+}
+
+}  // namespace
+
+// Starts a new file, the pipeline state is kept so a fork child or the
+// next file after a restart still gets the instructions in flight.
+void commit_trace_init() {
+    trace_on = Verilated::commandArgsPlusMatch("commit_trace")[0];
+    if (!trace_on) {
+        return;
+    }
+    const char* arg = Verilated::commandArgsPlusMatch("commit_trace_file=");
+    std::string name = arg[0] ? arg + strlen("+commit_trace_file=") : "my_top.ctrace";
+    uint32_t version = CT_VERSION;
+    trace_fp = fopen(name.c_str(), "wb");
+    if (!trace_fp) {
+        std::cout << "Warning: can not write " << name << ", no commit trace" << std::endl;
+        trace_on = false;
+        return;
+    }
+    fwrite(CT_MAGIC, 4, 1, trace_fp);
+    fwrite(&version, 4, 1, trace_fp);
+    last_cycle = 0;
+    harts.assign(harts.size(), ct_hart());
+    fill = 0;
+    pending = done = false;
+    bufs[0].reserve(buffer_size + 64);
+    bufs[1].reserve(buffer_size + 64);
+    writer = std::thread(writer_main);
+    std::cout << "Commit trace into " << name << std::endl;
+}
+
+void commit_trace_finish() {
+    if (!trace_on) {
+        return;
+    }
+    trace_on = false;
+    swap_buffers();
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        done = true;
+        cv.notify_all();
+    }
+    writer.join();
+    fclose(trace_fp);
+    trace_fp = NULL;
+}
+
+// DPI, hart decoded instr (16 bit ones in the low half).
+extern "C" void commit_trace_decode(int hart, int instr) {
+    if (trace_on) {
+        pipe(hart, 0).decoded.push_back((instr & 3) == 3 ? instr : instr & 0xffff);
+    }
+}
+
+// DPI, the oldest decoded instruction of hart issued as trans_id.
+extern "C" void commit_trace_issue(int hart, int trans_id) {
+    if (!trace_on) {
+        return;
+    }
+    ct_pipe& p = pipe(hart, trans_id);
+    p.instr_ok[trans_id] = !p.decoded.empty();
+    if (!p.decoded.empty()) {
+        p.instr[trans_id] = p.decoded.front();
+        p.decoded.pop_front();
+    }
+    p.addr_ok[trans_id] = 0;
+}
+
+// DPI, hart dropped its decoded instructions.
+extern "C" void commit_trace_flush(int hart) {
+    if (trace_on) {
+        pipe(hart, 0).decoded.clear();
+    }
+}
+
+// DPI, the LSU of hart works on the access of trans_id at virtual addr.
+extern "C" void commit_trace_lsu(int hart, int trans_id, long long addr) {
+    if (trace_on) {
+        ct_pipe& p = pipe(hart, trans_id);
+        p.addr[trans_id] = addr;
+        p.addr_ok[trans_id] = 1;
+    }
+}
+
+// DPI, one retired instruction of hart.
+extern "C" void commit_trace(int hart, int trans_id, long long pc, int rd, int rd_we,
+                             long long rd_data) {
+    if (!trace_on) {
+        return;
+    }
+    if (harts.size() <= (size_t) hart) {
+        harts.resize(hart + 1);
+    }
+    ct_hart& h = harts[hart];
+    ct_pipe& p = pipe(hart, trans_id);
+    std::vector<uint8_t>& buf = bufs[fill];
+    // core_ref_clk is 500 time units, see my_top.cpp
+    uint64_t cycle = (uint64_t) sc_time_stamp() / 500;
+    uint32_t instr = p.instr_ok[trans_id] ? p.instr[trans_id] : 0;
+    uint64_t addr = p.addr[trans_id];
+    uint8_t flags = (rd_we && rd) ? CT_RD : 0;
+    flags |= p.addr_ok[trans_id] ? CT_ADDR : 0;
+    flags |= p.instr_ok[trans_id] ? 0 : CT_NOINSTR;
+    p.instr_ok[trans_id] = p.addr_ok[trans_id] = 0;
+
+    ct_put(buf, hart);
+    ct_put(buf, cycle - last_cycle);
+    ct_put(buf, ct_zigzag(pc - h.next_pc));
+    ct_put(buf, instr);
+    buf.push_back(flags);
+    if (flags & CT_RD) {
+        buf.push_back(rd);
+        ct_put(buf, ct_zigzag(rd_data));
+    }
+    if (flags & CT_ADDR) {
+        ct_put(buf, ct_zigzag(addr - h.addr));
+        h.addr = addr;
+    }
+    last_cycle = cycle;
+    h.next_pc = pc + ct_instr_len(instr);
+    if (buf.size() >= buffer_size) {
+        swap_buffers();
+    }
+}
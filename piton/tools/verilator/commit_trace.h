@@ -0,0 +1,183 @@
+/*
+Copyright (c) 2019 Princeton University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Princeton University nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY PRINCETON UNIVERSITY "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL PRINCETON UNIVERSITY BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Binary commit trace of the ariane harts.
+//
+// manycore_top (built with -DCOMMIT_TRACE) calls commit_trace() for every
+// retired instruction, the harness writes the records from a background
+// thread. The instruction comes from decode and the memory address from
+// the LSU of the core (commit_trace_decode(), commit_trace_lsu()), never
+// from the memory or the registers, so they are right under translation,
+// for self-modifying code and in a trace that starts after a restore.
+// Run time plusargs
+//   +commit_trace          turn the trace on
+//   +commit_trace_file=N   output file (default my_top.ctrace)
+//
+// File format: the magic "PCTR", a 32 bit little endian version, then one
+// record per retired instruction
+//   varint   hart
+//   varint   core_ref_clk cycles since the previous record
+//   svarint  pc minus the next sequential pc of this hart
+//   varint   instruction, 16 bit for compressed ones
+//   byte     flags, CT_RD, CT_ADDR and CT_NOINSTR
+//   byte     rd              if CT_RD
+//   svarint  rd value        if CT_RD
+//   svarint  memory address minus the last one of this hart, if CT_ADDR
+// CT_NOINSTR marks an instruction that was in flight when the trace
+// started, its instruction is 0.
+// varints are LEB128, svarints zigzag encoded first. The reader below is
+// used by the ctrace tool (tools/src/ctrace).
+
+#ifndef COMMIT_TRACE_H
+#define COMMIT_TRACE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#define CT_MAGIC   "PCTR"
+#define CT_VERSION 1
+
+#define CT_RD      1
+#define CT_ADDR    2
+#define CT_NOINSTR 4
+
+struct ct_record {
+    uint32_t hart;
+    uint64_t cycle;
+    uint64_t pc;
+    uint32_t instr;
+    uint8_t flags;
+    uint8_t rd;
+    uint64_t rd_data;
+    uint64_t addr;
+};
+
+// delta state of one hart, the same on the writing and the reading side
+struct ct_hart {
+    uint64_t next_pc;
+    uint64_t addr;
+    ct_hart() : next_pc(0), addr(0) {}
+};
+
+inline uint64_t ct_zigzag(int64_t v) {
+    return ((uint64_t) v << 1) ^ (uint64_t) (v >> 63);
+}
+
+inline int64_t ct_unzigzag(uint64_t v) {
+    return (int64_t) (v >> 1) ^ -(int64_t) (v & 1);
+}
+
+inline uint32_t ct_instr_len(uint32_t instr) {
+    return (instr & 3) == 3 ? 4 : 2;
+}
+
+inline void ct_put(std::vector<uint8_t>& buf, uint64_t v) {
+    while (v >= 0x80) {
+        buf.push_back((uint8_t) (v | 0x80));
+        v >>= 7;
+    }
+    buf.push_back((uint8_t) v);
+}
+
+// Sequential reader, next() returns false at the end of the file.
+class ct_reader {
+public:
+    ct_reader() : fp(NULL), cycle(0) {}
+    ~ct_reader() {
+        if (fp) {
+            fclose(fp);
+        }
+    }
+    bool open(const char* name) {
+        char magic[4];
+        uint32_t version;
+        fp = fopen(name, "rb");
+        return fp && fread(magic, 4, 1, fp) == 1 && !memcmp(magic, CT_MAGIC, 4) &&
+               fread(&version, 4, 1, fp) == 1 && version == CT_VERSION;
+    }
+    bool next(ct_record& rec) {
+        uint64_t v;
+        if (!get(v)) {
+            return false;
+        }
+        rec.hart = (uint32_t) v;
+        if (harts.size() <= rec.hart) {
+            harts.resize(rec.hart + 1);
+        }
+        ct_hart& h = harts[rec.hart];
+        bool ok = get(v);
+        cycle += v;
+        rec.cycle = cycle;
+        ok = ok && get(v);
+        rec.pc = h.next_pc + ct_unzigzag(v);
+        ok = ok && get(v);
+        rec.instr = (uint32_t) v;
+        int flags = getc(fp);
+        rec.flags = flags;
+        rec.rd = 0;
+        rec.rd_data = 0;
+        rec.addr = 0;
+        if (ok && (flags & CT_RD)) {
+            rec.rd = getc(fp);
+            ok = get(v);
+            rec.rd_data = ct_unzigzag(v);
+        }
+        if (ok && (flags & CT_ADDR)) {
+            ok = get(v);
+            h.addr += ct_unzigzag(v);
+            rec.addr = h.addr;
+        }
+        h.next_pc = rec.pc + ct_instr_len(rec.instr);
+        return ok && flags != EOF;
+    }
+
+private:
+    FILE* fp;
+    uint64_t cycle;
+    std::vector<ct_hart> harts;
+
+    bool get(uint64_t& v) {
+        int c, shift = 0;
+        v = 0;
+        do {
+            if ((c = getc(fp)) == EOF) {
+                return false;
+            }
+            v |= (uint64_t) (c & 0x7f) << shift;
+            shift += 7;
+        } while (c & 0x80);
+        return true;
+    }
+};
+
+// harness side, see commit_trace.cc
+void commit_trace_init();
+void commit_trace_finish();
+
+#endif
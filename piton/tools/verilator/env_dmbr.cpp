@@ -0,0 +1,159 @@
+/*
+Copyright (c) 2019 Princeton University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Princeton University nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY PRINCETON UNIVERSITY "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL PRINCETON UNIVERSITY BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Verilator adapter of the dmbr environment, replays the stimulus of
+// verif/env/dmbr/test_dmbr.v on the dmbr module and prints its outputs
+// whenever they change, like the $monitor of the testbench. test_dmbr.v
+// predates the func_en/stall_en inputs and the curr_cred_bin outputs of
+// dmbr, both enables are on here. Like the testbench the run has no
+// checks, it passes when the stimulus is through.
+
+#include "Vdmbr.h"
+#include "vlt_harness.h"
+#include <stdio.h>
+
+// the inputs from this cycle on, they change after the falling edge
+struct dmbr_input {
+    uint64_t cycle;
+    CData proc_ld;
+    CData l1missIn;
+    CData l1missTag;
+    CData l2responseIn;
+    CData l2missIn;
+    CData l2missTag;
+};
+
+static const dmbr_input script[] = {
+    {  1, 1, 0, 0, 0, 0, 0 },
+    {  3, 0, 1, 0, 0, 0, 0 },
+    {  4, 0, 0, 0, 0, 0, 0 },
+    {  6, 0, 0, 0, 1, 1, 0 },
+    {  7, 0, 0, 0, 0, 0, 0 },
+    {  8, 0, 1, 1, 0, 0, 0 },
+    {  9, 0, 0, 0, 0, 0, 0 },
+    { 12, 0, 0, 0, 1, 1, 1 },
+    { 13, 0, 0, 0, 0, 0, 0 },
+    { 24, 0, 1, 2, 0, 0, 0 },
+    { 25, 0, 0, 0, 0, 0, 0 },
+    { 26, 0, 0, 0, 1, 0, 2 },
+    { 27, 0, 0, 0, 0, 0, 0 },
+    { 28, 0, 1, 3, 0, 0, 0 },
+    { 29, 0, 0, 0, 0, 0, 0 },
+    { 32, 0, 0, 0, 1, 1, 3 },
+    { 33, 0, 0, 0, 0, 0, 0 },
+    { 34, 0, 1, 0, 0, 0, 0 },
+    { 35, 0, 0, 0, 0, 0, 0 },
+    { 38, 0, 0, 0, 1, 1, 0 },
+    { 39, 0, 0, 0, 0, 0, 0 },
+    { 40, 0, 1, 1, 0, 0, 0 },
+    { 41, 0, 0, 0, 0, 0, 0 },
+    { 44, 0, 0, 0, 1, 1, 1 },
+    { 45, 0, 0, 0, 0, 1, 0 },
+    { 55, 0, 1, 2, 0, 1, 0 },
+    { 56, 0, 0, 2, 0, 1, 0 },
+    { 57, 0, 1, 3, 0, 1, 0 },
+    { 58, 0, 0, 3, 0, 1, 0 },
+    { 60, 0, 0, 3, 1, 1, 3 },
+    { 61, 0, 0, 3, 0, 0, 3 },
+    { 64, 0, 0, 3, 1, 1, 2 },
+    { 65, 0, 0, 3, 0, 0, 0 },
+    { 75, 0, 1, 0, 0, 0, 0 },
+    { 76, 0, 0, 0, 0, 0, 0 },
+    { 77, 0, 1, 1, 0, 0, 0 },
+    { 78, 0, 0, 1, 0, 0, 0 },
+    { 80, 0, 0, 1, 1, 0, 1 },
+    { 81, 0, 0, 1, 0, 0, 1 },
+    { 84, 0, 0, 1, 1, 1, 0 },
+    { 85, 0, 0, 1, 0, 0, 0 },
+};
+static const size_t script_len = sizeof(script) / sizeof(script[0]);
+// the testbench calls $finish here
+static const uint64_t last_cycle = 95;
+
+static void monitor(Vdmbr* top) {
+    static std::string last;
+    char line[256];
+    snprintf(line, sizeof(line),
+             "credit0:%u credit1:%u credit2:%u stallOut:%u l2responseIn:%u l2missIn:%u "
+             "l2missTag:%u l1missIn:%u l1missTag:%u",
+             top->curr_cred_bin_0, top->curr_cred_bin_1, top->curr_cred_bin_2, top->stallOut,
+             top->l2responseIn, top->l2missIn, top->l2missTag, top->l1missIn, top->l1missTag);
+    if (last != line) {
+        std::cout << line << std::endl;
+        last = line;
+    }
+}
+
+int main(int argc, char** argv) {
+    vlt_harness<Vdmbr> h("dmbr", argc, argv);
+    Vdmbr* top = h.top;
+    h.add_clock(&top->clk, 10000);
+
+    top->func_en = 1;
+    top->stall_en = 1;
+    top->creditIn_0 = 3;
+    top->creditIn_1 = 2;
+    top->creditIn_2 = 3;
+    top->creditIn_3 = 4;
+    top->creditIn_4 = 5;
+    top->creditIn_5 = 6;
+    top->creditIn_6 = 7;
+    top->creditIn_7 = 8;
+    top->creditIn_8 = 9;
+    top->creditIn_9 = 10;
+    top->replenishCyclesIn = 1000;
+    top->binScaleIn = 3;
+
+    vlt_reset_step reset[] = {
+        { &top->rst, 1, 1 },
+        { &top->rst, 0, 0 },
+    };
+    h.reset(reset, sizeof(reset) / sizeof(reset[0]));
+
+    size_t next = 0;
+    while (h.running()) {
+        h.negedge();
+        for (; next < script_len && script[next].cycle <= h.cycle(); next++) {
+            const dmbr_input& in = script[next];
+            top->proc_ld = in.proc_ld;
+            top->l1missIn = in.l1missIn;
+            top->l1missTag = in.l1missTag;
+            top->l2responseIn = in.l2responseIn;
+            top->l2missIn = in.l2missIn;
+            top->l2missTag = in.l2missTag;
+        }
+        h.eval();
+        monitor(top);
+        if (h.cycle() >= last_cycle) {
+            h.result(SIM_PASS);
+            break;
+        }
+        h.posedge();
+        monitor(top);
+    }
+    return h.finish();
+}
@@ -0,0 +1,180 @@
+/*
+Copyright (c) 2019 Princeton University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Princeton University nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY PRINCETON UNIVERSITY "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL PRINCETON UNIVERSITY BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Verilator adapter of the dynamic_node environment, plays back the
+// stimulus of verif/env/manycore/playback_driver_dynamic_node.v on
+// dynamic_node_top_wrap. The file alternates input vectors of 361 bits and
+// expected output vectors of 331 bits, most significant bit first, in the
+// port order of the playback driver. Input k is applied after rising edge
+// k and the outputs are checked against expected vector k before the next
+// falling edge, from the second pair on. x or z in an expected vector is
+// not checked, in an input vector it is 0.
+//   +stim_file=FILE       the vectors, text or the binary format of
+//                         tools/pli/playback/playback_io.h, read ahead on
+//                         a thread of their own
+
+#include "Vdynamic_node_top_wrap.h"
+#include "vlt_harness.h"
+#include "playback_io.h"
+#include <vector>
+
+// one vector of a stimulus record, fields are taken from the most
+// significant bit on
+class playback_vector {
+public:
+    playback_vector(uint32_t width) : words(2 * playback_words(width)), width(width), pos(width) {}
+
+    uint32_t* data() { return &words[0]; }
+    void rewind() { pos = width; }
+
+    // value of the next width bits, x and z are 0
+    uint64_t take(int width, uint64_t* care = NULL) {
+        uint64_t value = 0, mask = 0;
+        for (int i = 0; i < width; i++) {
+            int bit = playback_bit(&words[0], --pos);
+            value = value << 1 | (bit == 1);
+            mask = mask << 1 | (bit < 2);
+        }
+        if (care) {
+            *care = mask;
+        }
+        return value;
+    }
+
+private:
+    std::vector<uint32_t> words;
+    uint32_t width;
+    uint32_t pos;
+};
+
+static const uint32_t input_width = 361;
+static const uint32_t output_width = 331;
+
+static void apply(Vdynamic_node_top_wrap* top, playback_vector& in) {
+    top->reset_in = in.take(1);
+    top->dataIn_N = in.take(64);
+    top->dataIn_E = in.take(64);
+    top->dataIn_S = in.take(64);
+    top->dataIn_W = in.take(64);
+    top->dataIn_P = in.take(64);
+    top->validIn_N = in.take(1);
+    top->validIn_E = in.take(1);
+    top->validIn_S = in.take(1);
+    top->validIn_W = in.take(1);
+    top->validIn_P = in.take(1);
+    top->yummyIn_N = in.take(1);
+    top->yummyIn_E = in.take(1);
+    top->yummyIn_S = in.take(1);
+    top->yummyIn_W = in.take(1);
+    top->yummyIn_P = in.take(1);
+    top->myLocX = in.take(8);
+    top->myLocY = in.take(8);
+    top->myChipID = in.take(14);
+}
+
+// compare one port, prints the mismatching bits like displayMismatch of
+// the playback driver and returns true when there are any
+static bool check(const char* port, int width, uint64_t got, playback_vector& ref, uint64_t cycle) {
+    uint64_t care;
+    uint64_t exp = ref.take(width, &care);
+    uint64_t diff = (exp ^ got) & care;
+    for (int i = width - 1; diff && i >= 0; i--) {
+        if (diff >> i & 1) {
+            if (width > 1) {
+                std::cout << port << "[" << i << "]";
+            } else {
+                std::cout << port;
+            }
+            std::cout << ": Expect:" << (exp >> i & 1) << " Got:" << (got >> i & 1)
+                      << " at cycle " << cycle << std::endl;
+        }
+    }
+    return diff != 0;
+}
+
+static bool compare(Vdynamic_node_top_wrap* top, playback_vector& ref, uint64_t cycle) {
+    bool bad = false;
+    bad |= check("dataOut_N", 64, top->dataOut_N, ref, cycle);
+    bad |= check("dataOut_E", 64, top->dataOut_E, ref, cycle);
+    bad |= check("dataOut_S", 64, top->dataOut_S, ref, cycle);
+    bad |= check("dataOut_W", 64, top->dataOut_W, ref, cycle);
+    bad |= check("dataOut_P", 64, top->dataOut_P, ref, cycle);
+    bad |= check("validOut_N", 1, top->validOut_N, ref, cycle);
+    bad |= check("validOut_E", 1, top->validOut_E, ref, cycle);
+    bad |= check("validOut_S", 1, top->validOut_S, ref, cycle);
+    bad |= check("validOut_W", 1, top->validOut_W, ref, cycle);
+    bad |= check("validOut_P", 1, top->validOut_P, ref, cycle);
+    bad |= check("yummyOut_N", 1, top->yummyOut_N, ref, cycle);
+    bad |= check("yummyOut_E", 1, top->yummyOut_E, ref, cycle);
+    bad |= check("yummyOut_S", 1, top->yummyOut_S, ref, cycle);
+    bad |= check("yummyOut_W", 1, top->yummyOut_W, ref, cycle);
+    bad |= check("yummyOut_P", 1, top->yummyOut_P, ref, cycle);
+    bad |= check("thanksIn_P", 1, top->thanksIn_P, ref, cycle);
+    return bad;
+}
+
+int main(int argc, char** argv) {
+    vlt_harness<Vdynamic_node_top_wrap> h("dynamic_node", argc, argv);
+    Vdynamic_node_top_wrap* top = h.top;
+    h.add_clock(&top->clk, 1428);
+
+    std::string stim = vlt_plusarg_str("stim_file", "");
+    playback_reader in;
+    if (!in.open(stim, input_width, output_width)) {
+        std::cout << "Error: " << in.error() << std::endl;
+        h.result(SIM_FAIL);
+        return h.finish();
+    }
+
+    // the vectors drive reset_in, there is no reset script
+    sim_stats_phase("test", 0);
+    playback_vector vin(input_width), vout(output_width);
+    uint64_t pairs = 0, mismatch = 0;
+    while (h.running()) {
+        h.posedge();
+        if (!in.next(vin.data(), vout.data())) {
+            if (!mismatch) {
+                std::cout << "Playback PASSED!" << std::endl;
+                h.result(SIM_PASS);
+            } else {
+                std::cout << "Playback FAILED with " << mismatch << " mismatches!" << std::endl;
+                h.result(SIM_FAIL);
+            }
+            break;
+        }
+        vin.rewind();
+        vout.rewind();
+        apply(top, vin);
+        h.eval();
+        if (pairs++ && compare(top, vout, h.cycle() + 1)) {
+            mismatch++;
+            std::cout << "Number of cycles mismatched " << mismatch << std::endl;
+        }
+        h.negedge();
+    }
+    return h.finish();
+}
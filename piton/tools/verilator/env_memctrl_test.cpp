@@ -0,0 +1,65 @@
+/*
+Copyright (c) 2019 Princeton University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Princeton University nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY PRINCETON UNIVERSITY "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL PRINCETON UNIVERSITY BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Verilator adapter of the memctrl_test environment, drives
+// memctrl_test_top_helper in place of the timed memctrl_test_top.
+//   +addr_mode=N          sw[2:0] of memctrl_test (default 7, 64 byte)
+//   +test_mode=N          sw[7:3] of memctrl_test (default 0, walk ones)
+//   +timeout_cycles=N     the test fails when it is not done after N
+//                         cycles (default 1000000, as the timed top)
+// The test passes when the leds show done and passed.
+
+#include "Vmemctrl_test_top_helper.h"
+#include "vlt_harness.h"
+
+int main(int argc, char** argv) {
+    vlt_harness<Vmemctrl_test_top_helper> h("memctrl_test", argc, argv);
+    Vmemctrl_test_top_helper* top = h.top;
+    h.add_clock(&top->test_sys_clk, 1000, 0, "test_sys_clk");
+    h.add_clock(&top->mc_sys_clk, 5000, 0, "mc_sys_clk");
+    top->addr_mode = vlt_plusarg_u64("addr_mode", 7);
+    top->test_mode = vlt_plusarg_u64("test_mode", 0);
+
+    vlt_reset_step script[] = {
+        { &top->rst_n, 1, 110 },
+        { &top->rst_n, 0, 100 },
+        { &top->rst_n, 1, 0 },
+    };
+    h.reset(script, sizeof(script) / sizeof(script[0]));
+
+    uint64_t timeout = h.cycle() + vlt_plusarg_u64("timeout_cycles", 1000000);
+    while (h.running()) {
+        h.posedge();
+        if (top->done) {
+            h.result(SIM_PASS);
+        } else if (h.cycle() >= timeout) {
+            std::cout << "        [FAILED] Test (Timeout check) failed" << std::endl;
+            h.result(SIM_FAIL);
+        }
+    }
+    return h.finish();
+}
@@ -0,0 +1,66 @@
+/*
+Copyright (c) 2019 Princeton University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Princeton University nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY PRINCETON UNIVERSITY "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL PRINCETON UNIVERSITY BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Verilator adapter of the sdctrl_test environment, drives
+// sdctrl_test_top_helper in place of the timed sdctrl_test_top.
+//   +addr_mode=N          sw[2:0] of sdctrl_test (default 4, 8 byte)
+//   +test_mode=N          sw[7:3] of sdctrl_test (default 1, address own)
+//   +timeout_cycles=N     the test fails when it is not done after N
+//                         cycles (default 0, never, use +max_cycles)
+// The test passes when the leds show done and passed.
+
+#include "Vsdctrl_test_top_helper.h"
+#include "vlt_harness.h"
+
+int main(int argc, char** argv) {
+    vlt_harness<Vsdctrl_test_top_helper> h("sdctrl_test", argc, argv);
+    Vsdctrl_test_top_helper* top = h.top;
+    h.add_clock(&top->test_sys_clk, 1000, 0, "test_sys_clk");
+    h.add_clock(&top->spi_sys_clk, 2500, 0, "spi_sys_clk");
+    top->addr_mode = vlt_plusarg_u64("addr_mode", 4);
+    top->test_mode = vlt_plusarg_u64("test_mode", 1);
+
+    vlt_reset_step script[] = {
+        { &top->rst_n, 1, 110 },
+        { &top->rst_n, 0, 100 },
+        { &top->rst_n, 1, 0 },
+    };
+    h.reset(script, sizeof(script) / sizeof(script[0]));
+
+    uint64_t timeout = vlt_plusarg_u64("timeout_cycles", 0);
+    timeout = timeout ? h.cycle() + timeout : ~0ULL;
+    while (h.running()) {
+        h.posedge();
+        if (top->done) {
+            h.result(SIM_PASS);
+        } else if (h.cycle() >= timeout) {
+            std::cout << "        [FAILED] Test (Timeout check) failed" << std::endl;
+            h.result(SIM_FAIL);
+        }
+    }
+    return h.finish();
+}
@@ -0,0 +1,88 @@
+/*
+Copyright (c) 2019 Princeton University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Princeton University nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY PRINCETON UNIVERSITY "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL PRINCETON UNIVERSITY BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Verilator adapter of the uart_serializer environment, drives
+// uart_serializer_top_helper in place of the timed uart_serializer_top.
+//   +test_cases_path=DIR  directory of the vectors (set by the config)
+//   +test_case=NAME       runs DIR/NAME_src.vmh against DIR/NAME_sink.vmh
+//   +timeout_cycles=N     the test fails when it is not done after N
+//                         cycles (default 1000, as the timed top)
+
+#include "Vuart_serializer_top_helper.h"
+#include "vlt_harness.h"
+#include "svdpi.h"
+
+extern "C" void test_source_load(const char* file, int entries);
+extern "C" void test_sink_load(const char* file, int entries);
+
+// load the vectors of one side, false when there are none
+static bool load(const char* scope, void (*loader)(const char*, int), const std::string& file) {
+    uint64_t entries = vlt_readmemh_entries(file.c_str());
+    if (!entries) {
+        std::cout << "Error: no vectors in " << file << std::endl;
+        return false;
+    }
+    svSetScope(svGetScopeFromName(scope));
+    loader(file.c_str(), entries);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    vlt_harness<Vuart_serializer_top_helper> h("uart_serializer", argc, argv);
+    Vuart_serializer_top_helper* top = h.top;
+    h.add_clock(&top->clk, 1000);
+    // initial blocks first, they would undo the loading
+    h.eval();
+
+    std::string test = vlt_plusarg_str("test_cases_path", "") + vlt_plusarg_str("test_case", "");
+    std::cout << " + Running Test Case: " << test << std::endl;
+    if (!load("TOP.uart_serializer_top_helper.src", test_source_load, test + "_src.vmh") ||
+        !load("TOP.uart_serializer_top_helper.sink", test_sink_load, test + "_sink.vmh")) {
+        h.result(SIM_FAIL);
+        return h.finish();
+    }
+
+    // TEST_CASE_RESET of test_infrstrct.v
+    vlt_reset_step script[] = {
+        { &top->rst_n, 1, 1 },
+        { &top->rst_n, 0, 3 },
+        { &top->rst_n, 1, 0 },
+    };
+    h.reset(script, sizeof(script) / sizeof(script[0]));
+
+    uint64_t timeout = h.cycle() + vlt_plusarg_u64("timeout_cycles", 1000);
+    while (h.running()) {
+        h.posedge();
+        if (top->done) {
+            h.result(SIM_PASS);
+        } else if (h.cycle() >= timeout) {
+            std::cout << "        [FAILED] Test (Timeout check) failed" << std::endl;
+            h.result(SIM_FAIL);
+        }
+    }
+    return h.finish();
+}
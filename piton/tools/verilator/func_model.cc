@@ -0,0 +1,515 @@
+/*
+Copyright (c) 2019 Princeton University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Princeton University nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY PRINCETON UNIVERSITY "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL PRINCETON UNIVERSITY BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "func_model.h"
+#include "iob_sim.h"
+
+namespace {
+
+// LR reservations of all harts, any store to the reserved double word
+// cancels them
+std::map<uint32_t, uint64_t> reservations;
+
+inline uint32_t bits(uint32_t v, int hi, int lo) {
+    return (v >> lo) & ((1u << (hi - lo + 1)) - 1);
+}
+
+inline int64_t sext(uint64_t v, int width) {
+    return (int64_t) (v << (64 - width)) >> (64 - width);
+}
+
+inline uint32_t enc_r(uint32_t f7, uint32_t rs2, uint32_t rs1, uint32_t f3, uint32_t rd, uint32_t op) {
+    return f7 << 25 | rs2 << 20 | rs1 << 15 | f3 << 12 | rd << 7 | op;
+}
+
+inline uint32_t enc_i(uint32_t imm, uint32_t rs1, uint32_t f3, uint32_t rd, uint32_t op) {
+    return (imm & 0xfff) << 20 | rs1 << 15 | f3 << 12 | rd << 7 | op;
+}
+
+inline uint32_t enc_s(uint32_t imm, uint32_t rs2, uint32_t rs1, uint32_t f3, uint32_t op) {
+    return bits(imm, 11, 5) << 25 | rs2 << 20 | rs1 << 15 | f3 << 12 | bits(imm, 4, 0) << 7 | op;
+}
+
+inline uint32_t enc_b(uint32_t imm, uint32_t rs2, uint32_t rs1, uint32_t f3, uint32_t op) {
+    return bits(imm, 12, 12) << 31 | bits(imm, 10, 5) << 25 | rs2 << 20 | rs1 << 15 | f3 << 12 |
+           bits(imm, 4, 1) << 8 | bits(imm, 11, 11) << 7 | op;
+}
+
+inline uint32_t enc_j(uint32_t imm, uint32_t rd, uint32_t op) {
+    return bits(imm, 20, 20) << 31 | bits(imm, 10, 1) << 21 | bits(imm, 11, 11) << 20 |
+           bits(imm, 19, 12) << 12 | rd << 7 | op;
+}
+
+inline int64_t imm_i(uint32_t in) {
+    return (int32_t) in >> 20;
+}
+
+inline int64_t imm_s(uint32_t in) {
+    return (int32_t) ((uint32_t) ((int32_t) (in & 0xfe000000) >> 20) | bits(in, 11, 7));
+}
+
+inline int64_t imm_b(uint32_t in) {
+    return (int32_t) ((uint32_t) ((int32_t) (in & 0x80000000) >> 19) | (in & 0x80) << 4 |
+                      (in >> 20 & 0x7e0) | (in >> 7 & 0x1e));
+}
+
+inline int64_t imm_u(uint32_t in) {
+    return (int32_t) (in & 0xfffff000);
+}
+
+inline int64_t imm_j(uint32_t in) {
+    return (int32_t) ((uint32_t) ((int32_t) (in & 0x80000000) >> 11) | (in & 0xff000) |
+                      (in >> 9 & 0x800) | (in >> 20 & 0x7fe));
+}
+
+uint64_t alu(uint32_t f3, bool alt, uint64_t a, uint64_t b) {
+    switch (f3) {
+    case 0: return alt ? a - b : a + b;
+    case 1: return a << (b & 63);
+    case 2: return (int64_t) a < (int64_t) b;
+    case 3: return a < b;
+    case 4: return a ^ b;
+    case 5: return alt ? (uint64_t) ((int64_t) a >> (b & 63)) : a >> (b & 63);
+    case 6: return a | b;
+    default: return a & b;
+    }
+}
+
+uint64_t alu32(uint32_t f3, bool alt, uint64_t a, uint64_t b) {
+    uint32_t x = (uint32_t) a, y = (uint32_t) b;
+    switch (f3) {
+    case 0: return sext(alt ? x - y : x + y, 32);
+    case 1: return sext(x << (y & 31), 32);
+    default: return sext(alt ? (uint32_t) ((int32_t) x >> (y & 31)) : x >> (y & 31), 32);
+    }
+}
+
+uint64_t muldiv(uint32_t f3, uint64_t a, uint64_t b) {
+    int64_t sa = a, sb = b;
+    switch (f3) {
+    case 0: return a * b;
+    case 1: return (uint64_t) (((__int128) sa * sb) >> 64);
+    case 2: return (uint64_t) (((__int128) sa * (__int128) b) >> 64);
+    case 3: return (uint64_t) (((unsigned __int128) a * b) >> 64);
+    case 4: return !b ? ~0ULL : (sa == INT64_MIN && sb == -1) ? a : (uint64_t) (sa / sb);
+    case 5: return !b ? ~0ULL : a / b;
+    case 6: return !b ? a : (sa == INT64_MIN && sb == -1) ? 0 : (uint64_t) (sa % sb);
+    default: return !b ? a : a % b;
+    }
+}
+
+uint64_t muldiv32(uint32_t f3, uint64_t a, uint64_t b) {
+    int32_t sa = a, sb = b;
+    uint32_t ua = a, ub = b;
+    switch (f3) {
+    case 0: return sext(ua * ub, 32);
+    case 4: return sext(!ub ? ~0u : (sa == INT32_MIN && sb == -1) ? ua : (uint32_t) (sa / sb), 32);
+    case 5: return sext(!ub ? ~0u : ua / ub, 32);
+    case 6: return sext(!ub ? ua : (sa == INT32_MIN && sb == -1) ? 0 : (uint32_t) (sa % sb), 32);
+    default: return sext(!ub ? ua : ua % ub, 32);
+    }
+}
+
+}  // namespace
+
+// The memory model packs the bytes of a 64 bit word big endian.
+uint64_t func_mem_read(uint64_t addr, int size) {
+    uint64_t val = 0, key = ~0ULL, word = 0;
+    for (int i = 0; i < size; i++) {
+        uint64_t a = addr + i;
+        if ((a & ~7ULL) != key) {
+            key = a & ~7ULL;
+            word = iob_model_read(key);
+        }
+        val |= ((word >> (56 - 8 * (a & 7))) & 0xff) << (8 * i);
+    }
+    return val;
+}
+
+void func_mem_write(uint64_t addr, int size, uint64_t val) {
+    for (int i = 0; i < size;) {
+        uint64_t key = (addr + i) & ~7ULL;
+        uint64_t word = iob_model_read(key);
+        for (; i < size && ((addr + i) & ~7ULL) == key; i++) {
+            int shift = 56 - 8 * ((addr + i) & 7);
+            word = (word & ~(0xffULL << shift)) | (((val >> (8 * i)) & 0xff) << shift);
+        }
+        iob_model_write(key, word);
+    }
+}
+
+uint32_t func_expand(uint32_t c) {
+    uint32_t rd = bits(c, 11, 7), rs2 = bits(c, 6, 2);
+    uint32_t rdp = bits(c, 4, 2) + 8, rs1p = bits(c, 9, 7) + 8;
+    uint32_t imm6 = sext(bits(c, 12, 12) << 5 | bits(c, 6, 2), 6);
+    uint32_t shamt = bits(c, 12, 12) << 5 | bits(c, 6, 2);
+    uint32_t off_w = bits(c, 5, 5) << 6 | bits(c, 12, 10) << 3 | bits(c, 6, 6) << 2;
+    uint32_t off_d = bits(c, 6, 5) << 6 | bits(c, 12, 10) << 3;
+    uint32_t imm;
+    switch ((c & 3) << 3 | bits(c, 15, 13)) {
+    case 0x00:  // C.ADDI4SPN
+        imm = bits(c, 10, 7) << 6 | bits(c, 12, 11) << 4 | bits(c, 5, 5) << 3 | bits(c, 6, 6) << 2;
+        return imm ? enc_i(imm, 2, 0, rdp, 0x13) : 0;
+    case 0x02: return enc_i(off_w, rs1p, 2, rdp, 0x03);        // C.LW
+    case 0x03: return enc_i(off_d, rs1p, 3, rdp, 0x03);        // C.LD
+    case 0x06: return enc_s(off_w, rdp, rs1p, 2, 0x23);        // C.SW
+    case 0x07: return enc_s(off_d, rdp, rs1p, 3, 0x23);        // C.SD
+    case 0x08: return enc_i(imm6, rd, 0, rd, 0x13);            // C.ADDI
+    case 0x09: return rd ? enc_i(imm6, rd, 0, rd, 0x1b) : 0;   // C.ADDIW
+    case 0x0a: return enc_i(imm6, 0, 0, rd, 0x13);             // C.LI
+    case 0x0b:
+        if (rd == 2) {  // C.ADDI16SP
+            imm = sext(bits(c, 12, 12) << 9 | bits(c, 4, 3) << 7 | bits(c, 5, 5) << 6 |
+                       bits(c, 2, 2) << 5 | bits(c, 6, 6) << 4, 10);
+            return imm ? enc_i(imm, 2, 0, 2, 0x13) : 0;
+        }
+        return imm6 ? (imm6 << 12) | rd << 7 | 0x37 : 0;       // C.LUI
+    case 0x0c:
+        switch (bits(c, 11, 10)) {
+        case 0: return enc_i(shamt, rs1p, 5, rs1p, 0x13);         // C.SRLI
+        case 1: return enc_i(shamt | 0x400, rs1p, 5, rs1p, 0x13); // C.SRAI
+        case 2: return enc_i(imm6, rs1p, 7, rs1p, 0x13);          // C.ANDI
+        }
+        if (!bits(c, 12, 12)) {
+            static const uint32_t f3[4] = {0, 4, 6, 7};         // SUB XOR OR AND
+            return enc_r(bits(c, 6, 5) ? 0 : 0x20, rdp, rs1p, f3[bits(c, 6, 5)], rs1p, 0x33);
+        }
+        if (bits(c, 6, 5) < 2) {                                // SUBW ADDW
+            return enc_r(bits(c, 6, 5) ? 0 : 0x20, rdp, rs1p, 0, rs1p, 0x3b);
+        }
+        return 0;
+    case 0x0d:  // C.J
+        imm = sext(bits(c, 12, 12) << 11 | bits(c, 11, 11) << 4 | bits(c, 10, 9) << 8 |
+                   bits(c, 8, 8) << 10 | bits(c, 7, 7) << 6 | bits(c, 6, 6) << 7 |
+                   bits(c, 5, 3) << 1 | bits(c, 2, 2) << 5, 12);
+        return enc_j(imm, 0, 0x6f);
+    case 0x0e: case 0x0f:  // C.BEQZ, C.BNEZ
+        imm = sext(bits(c, 12, 12) << 8 | bits(c, 11, 10) << 3 | bits(c, 6, 5) << 6 |
+                   bits(c, 4, 3) << 1 | bits(c, 2, 2) << 5, 9);
+        return enc_b(imm, 0, rs1p, bits(c, 13, 13), 0x63);
+    case 0x10: return enc_i(shamt, rd, 1, rd, 0x13);           // C.SLLI
+    case 0x12:  // C.LWSP
+        imm = bits(c, 12, 12) << 5 | bits(c, 6, 4) << 2 | bits(c, 3, 2) << 6;
+        return rd ? enc_i(imm, 2, 2, rd, 0x03) : 0;
+    case 0x13:  // C.LDSP
+        imm = bits(c, 12, 12) << 5 | bits(c, 6, 5) << 3 | bits(c, 4, 2) << 6;
+        return rd ? enc_i(imm, 2, 3, rd, 0x03) : 0;
+    case 0x14:
+        if (!bits(c, 12, 12)) {  // C.JR, C.MV
+            return rs2 ? enc_r(0, rs2, 0, 0, rd, 0x33) : rd ? enc_i(0, rd, 0, 0, 0x67) : 0;
+        }
+        if (!rs2) {              // C.EBREAK, C.JALR
+            return rd ? enc_i(0, rd, 0, 1, 0x67) : 0x00100073;
+        }
+        return enc_r(0, rs2, rd, 0, rd, 0x33);                 // C.ADD
+    case 0x16: return enc_s(bits(c, 12, 9) << 2 | bits(c, 8, 7) << 6, rs2, 2, 2, 0x23);  // C.SWSP
+    case 0x17: return enc_s(bits(c, 12, 10) << 3 | bits(c, 9, 7) << 6, rs2, 2, 3, 0x23); // C.SDSP
+    }
+    return 0;
+}
+
+void func_boot_stub(uint64_t entry, uint64_t addr, const std::vector<func_hart>& harts) {
+    std::vector<uint32_t> code;
+    code.push_back(enc_i(0xf14, 0, 2, 31, 0x73));           // csrr   x31, mhartid
+    code.push_back(enc_i(harts.size(), 0, 0, 30, 0x13));     // li     x30, harts
+    code.push_back(0);                                       // bgeu   x31, x30, park
+    code.push_back(enc_i(9, 31, 1, 31, 0x13));               // slli   x31, x31, 9
+    code.push_back(30 << 7 | 0x17);                          // auipc  x30, 0
+    code.push_back(enc_r(0, 30, 31, 0, 31, 0x33));           // add    x31, x31, x30
+    code.push_back(enc_i(496, 31, 3, 30, 0x03));             // ld     x30, lines
+    code.push_back(enc_i(504, 31, 3, 29, 0x03));             // ld     x29, line list
+    code.push_back(enc_b(24, 0, 30, 0, 0x63));               // beqz   x30, 1f
+    code.push_back(enc_i(0, 29, 3, 28, 0x03));               // 0: ld  x28, 0(x29)
+    code.push_back(enc_i(0, 28, 3, 28, 0x03));               //    ld  x28, 0(x28)
+    code.push_back(enc_i(8, 29, 0, 29, 0x13));               //    addi x29, x29, 8
+    code.push_back(enc_i(0xfff, 30, 0, 30, 0x13));           //    addi x30, x30, -1
+    code.push_back(enc_b(-16, 0, 30, 1, 0x63));              //    bnez x30, 0b
+    code.push_back(enc_i(240, 31, 3, 30, 0x03));             // 1: ld  x30, pc
+    code.push_back(enc_i(0x341, 30, 1, 0, 0x73));            // csrw   mepc, x30
+    code.push_back(2 << 12 | 30 << 7 | 0x37);                // lui    x30, 2
+    code.push_back(enc_i(0x800, 30, 0, 30, 0x13));           // addi   x30, x30, -2048
+    code.push_back(enc_i(0x300, 30, 2, 0, 0x73));            // csrs   mstatus, x30 (MPP = M)
+    for (uint32_t r = 1; r < 32; r++) {
+        code.push_back(enc_i(240 + 8 * r, 31, 3, r, 0x03));  // ld     xr, xr
+    }
+    code.push_back(0x30200073);                              // mret
+    const uint64_t park = 4 * code.size();
+    code[2] = enc_b(park - 8, 30, 31, 7, 0x63);
+    code.push_back(0x10500073);                              // park: wfi
+    code.push_back(enc_j(-4, 0, 0x6f));                      //       j park
+    for (size_t i = 0; i < code.size(); i++) {
+        func_mem_write(addr + 4 * i, 4, code[i]);
+    }
+    uint64_t list = addr + 256 + 512 * harts.size();
+    for (size_t h = 0; h < harts.size(); h++) {
+        uint64_t slot = addr + 256 + 512 * h;
+        func_mem_write(slot, 8, harts[h].done ? addr + park : harts[h].pc);
+        for (int r = 1; r < 32; r++) {
+            func_mem_write(slot + 8 * r, 8, harts[h].x[r]);
+        }
+        std::vector<uint64_t> lines;
+        if (!harts[h].done) {
+            lines = harts[h].warm_lines();
+        }
+        func_mem_write(slot + 256, 8, lines.size());
+        func_mem_write(slot + 264, 8, list);
+        for (size_t i = 0; i < lines.size(); i++) {
+            func_mem_write(list + 8 * i, 8, lines[i]);
+        }
+        list += 8 * harts[h].warm_max();
+    }
+    if (entry != addr) {
+        uint64_t off = addr - entry;
+        uint32_t lo = off & 0xfff;
+        func_mem_write(entry, 4, ((uint32_t) (off + 0x800) & 0xfffff000) | 31 << 7 | 0x17);  // auipc x31
+        func_mem_write(entry + 4, 4, enc_i(lo, 31, 0, 0, 0x67));                            // jr x31
+    }
+}
+
+uint64_t func_boot_stub_size(const std::vector<func_hart>& harts) {
+    uint64_t size = 256;
+    for (size_t h = 0; h < harts.size(); h++) {
+        size += 512 + 8 * harts[h].warm_max();
+    }
+    return size;
+}
+
+func_hart::func_hart(uint32_t id, uint64_t pc)
+    : pc(pc), instret(0), id(id), done(false), warm_clock(0), warm_last(~0ULL), warm_cap(0) {
+    for (int i = 0; i < 32; i++) {
+        x[i] = 0;
+    }
+    // what the boot rom passes on
+    x[10] = id;
+}
+
+void func_hart::warm(size_t max) {
+    warm_cap = max;
+    warm_touch.clear();
+    warm_line.clear();
+    warm_last = ~0ULL;
+}
+
+std::vector<uint64_t> func_hart::warm_lines() const {
+    std::vector<uint64_t> lines;
+    for (std::map<uint64_t, uint64_t>::const_iterator i = warm_line.begin(); i != warm_line.end(); ++i) {
+        lines.push_back(i->second);
+    }
+    return lines;
+}
+
+// Addresses with bit 39 set are the uncached I/O space of the chip, a
+// load in the boot stub could have side effects there.
+void func_hart::touch(uint64_t addr) {
+    uint64_t line = addr & ~63ULL;
+    if (!warm_cap || line == warm_last || (line >> 39 & 1)) {
+        return;
+    }
+    warm_last = line;
+    std::map<uint64_t, uint64_t>::iterator i = warm_touch.find(line);
+    if (i != warm_touch.end()) {
+        warm_line.erase(i->second);
+        i->second = warm_clock;
+    } else {
+        warm_touch[line] = warm_clock;
+        if (warm_touch.size() > warm_cap) {
+            warm_touch.erase(warm_line.begin()->second);
+            warm_line.erase(warm_line.begin());
+        }
+    }
+    warm_line[warm_clock++] = line;
+}
+
+int func_hart::step() {
+    touch(pc);
+    uint32_t instr = func_mem_read(pc, 2);
+    if ((instr & 3) != 3) {
+        instr = func_expand(instr);
+        return instr ? exec(instr, 2) : FM_ILLEGAL;
+    }
+    return exec(func_mem_read(pc, 4), 4);
+}
+
+void func_hart::store(uint64_t addr, int size, uint64_t val) {
+    touch(addr);
+    for (std::map<uint32_t, uint64_t>::iterator i = reservations.begin(); i != reservations.end();) {
+        if (i->second == (addr & ~7ULL)) {
+            reservations.erase(i++);
+        } else {
+            ++i;
+        }
+    }
+    func_mem_write(addr, size, val);
+}
+
+bool func_hart::csr(uint32_t num, uint32_t op, uint64_t in, uint64_t& out) {
+    switch (num) {
+    case 0xf14: out = id; return true;                              // mhartid
+    case 0xb00: case 0xb02: case 0xc00: case 0xc01: case 0xc02:     // counters
+        out = instret;
+        return true;
+    }
+    out = csrs[num];
+    switch (op) {
+    case 1: csrs[num] = in; break;
+    case 2: csrs[num] = out | in; break;
+    case 3: csrs[num] = out & ~in; break;
+    default: return false;
+    }
+    return true;
+}
+
+bool func_hart::amo(uint32_t in, uint64_t addr, uint64_t src, uint64_t& out) {
+    int size = bits(in, 14, 12) == 2 ? 4 : 8;
+    uint32_t f5 = bits(in, 31, 27);
+    touch(addr);
+    if (f5 == 0x02) {       // LR
+        out = func_mem_read(addr, size);
+        out = size == 4 ? sext(out, 32) : out;
+        reservations[id] = addr & ~7ULL;
+        return true;
+    }
+    if (f5 == 0x03) {       // SC
+        std::map<uint32_t, uint64_t>::iterator i = reservations.find(id);
+        out = !(i != reservations.end() && i->second == (addr & ~7ULL));
+        reservations.erase(id);
+        if (!out) {
+            store(addr, size, src);
+        }
+        return true;
+    }
+    uint64_t old = func_mem_read(addr, size);
+    int64_t a = size == 4 ? sext(old, 32) : (int64_t) old;
+    int64_t b = size == 4 ? sext(src, 32) : (int64_t) src;
+    uint64_t ua = size == 4 ? (uint32_t) old : old, ub = size == 4 ? (uint32_t) src : src;
+    uint64_t val;
+    switch (f5) {
+    case 0x01: val = src; break;
+    case 0x00: val = old + src; break;
+    case 0x04: val = old ^ src; break;
+    case 0x0c: val = old & src; break;
+    case 0x08: val = old | src; break;
+    case 0x10: val = a < b ? a : b; break;
+    case 0x14: val = a > b ? a : b; break;
+    case 0x18: val = ua < ub ? ua : ub; break;
+    case 0x1c: val = ua > ub ? ua : ub; break;
+    default: return false;
+    }
+    store(addr, size, val);
+    out = a;
+    return true;
+}
+
+int func_hart::exec(uint32_t in, uint32_t len) {
+    uint32_t op = in & 0x7f, rd = bits(in, 11, 7), f3 = bits(in, 14, 12), f7 = in >> 25;
+    uint64_t a = x[bits(in, 19, 15)], b = x[bits(in, 24, 20)];
+    uint64_t next = pc + len, val = 0;
+    bool taken;
+    switch (op) {
+    case 0x37: val = imm_u(in); break;                              // LUI
+    case 0x17: val = pc + imm_u(in); break;                         // AUIPC
+    case 0x6f: val = next; next = pc + imm_j(in); break;            // JAL
+    case 0x67:                                                      // JALR
+        val = next;
+        next = (a + imm_i(in)) & ~1ULL;
+        break;
+    case 0x63:                                                      // BRANCH
+        switch (f3) {
+        case 0: taken = a == b; break;
+        case 1: taken = a != b; break;
+        case 4: taken = (int64_t) a < (int64_t) b; break;
+        case 5: taken = (int64_t) a >= (int64_t) b; break;
+        case 6: taken = a < b; break;
+        case 7: taken = a >= b; break;
+        default: return FM_ILLEGAL;
+        }
+        next = taken ? pc + imm_b(in) : next;
+        rd = 0;
+        break;
+    case 0x03:                                                      // LOAD
+        if (f3 == 7) {
+            return FM_ILLEGAL;
+        }
+        touch(a + imm_i(in));
+        val = func_mem_read(a + imm_i(in), 1 << (f3 & 3));
+        val = (f3 & 4) || f3 == 3 ? val : sext(val, 8 << f3);
+        break;
+    case 0x23:                                                      // STORE
+        if (f3 > 3) {
+            return FM_ILLEGAL;
+        }
+        store(a + imm_s(in), 1 << f3, b);
+        rd = 0;
+        break;
+    case 0x13:                                                      // OP-IMM
+        val = alu(f3, f3 == 5 && (in >> 30 & 1), a, f3 == 1 || f3 == 5 ? bits(in, 25, 20) : imm_i(in));
+        break;
+    case 0x1b:                                                      // OP-IMM-32
+        if (f3 != 0 && f3 != 1 && f3 != 5) {
+            return FM_ILLEGAL;
+        }
+        val = alu32(f3, f3 == 5 && (in >> 30 & 1), a, f3 ? bits(in, 24, 20) : imm_i(in));
+        break;
+    case 0x33:                                                      // OP
+        val = f7 == 1 ? muldiv(f3, a, b) : alu(f3, f7 == 0x20, a, b);
+        break;
+    case 0x3b:                                                      // OP-32
+        if (f7 == 1 ? (f3 > 0 && f3 < 4) : (f3 != 0 && f3 != 1 && f3 != 5)) {
+            return FM_ILLEGAL;
+        }
+        val = f7 == 1 ? muldiv32(f3, a, b) : alu32(f3, f7 == 0x20, a, b);
+        break;
+    case 0x0f:                                                      // FENCE
+        rd = 0;
+        break;
+    case 0x2f:                                                      // AMO
+        if ((f3 != 2 && f3 != 3) || !amo(in, a, b, val)) {
+            return FM_ILLEGAL;
+        }
+        break;
+    case 0x73:                                                      // SYSTEM
+        if (in == 0x00000073) {
+            return FM_ECALL;
+        } else if (in == 0x00100073) {
+            return FM_EBREAK;
+        } else if (in == 0x10500073) {                              // WFI
+            rd = 0;
+        } else if (!f3 || f3 == 4 ||
+                   !csr(in >> 20, f3 & 3, f3 & 4 ? bits(in, 19, 15) : a, val)) {
+            return FM_ILLEGAL;
+        }
+        break;
+    default:
+        return FM_ILLEGAL;
+    }
+    if (rd) {
+        x[rd] = val;
+    }
+    pc = next;
+    instret++;
+    return FM_OK;
+}
@@ -0,0 +1,103 @@
+/*
+Copyright (c) 2019 Princeton University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Princeton University nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY PRINCETON UNIVERSITY "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL PRINCETON UNIVERSITY BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Functional RV64IMAC hart model for the sampled simulation of the
+// verilator harness (see run_sampled() in my_top.cpp).
+//
+// It executes bare-metal machine mode code straight on the DPI memory
+// model, one instruction per step(): no caches, no timing, no MMU, no
+// interrupts and no floating point. CSRs are a plain map except for
+// mhartid and the counters. ecall, ebreak and anything it does not know
+// stop the hart.
+
+#ifndef FUNC_MODEL_H
+#define FUNC_MODEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <map>
+#include <vector>
+
+// step() results
+#define FM_OK      0
+#define FM_ECALL   1
+#define FM_EBREAK  2
+#define FM_ILLEGAL 3
+
+class func_hart {
+public:
+    uint64_t x[32];
+    uint64_t pc;
+    uint64_t instret;
+    uint32_t id;
+    bool done;
+
+    func_hart(uint32_t id, uint64_t pc);
+    int step();
+
+    // Cacheable lines (64 bytes) the hart fetched, loaded or stored most
+    // recently, at most max of them, for the cache warm-up of the boot
+    // stub. Off (0) by default.
+    void warm(size_t max);
+    size_t warm_max() const { return warm_cap; }
+    std::vector<uint64_t> warm_lines() const;   // oldest first
+
+private:
+    std::map<uint32_t, uint64_t> csrs;
+    // line -> last touch and back, the oldest touch is first
+    std::map<uint64_t, uint64_t> warm_touch;
+    std::map<uint64_t, uint64_t> warm_line;
+    uint64_t warm_clock, warm_last;
+    size_t warm_cap;
+
+    void touch(uint64_t addr);
+
+    int exec(uint32_t instr, uint32_t len);
+    bool csr(uint32_t num, uint32_t op, uint64_t in, uint64_t& out);
+    bool amo(uint32_t instr, uint64_t addr, uint64_t src, uint64_t& out);
+    void store(uint64_t addr, int size, uint64_t val);
+};
+
+// memory access through iob_model_read/iob_model_write, little endian
+uint64_t func_mem_read(uint64_t addr, int size);
+void func_mem_write(uint64_t addr, int size, uint64_t val);
+
+// Boot stub for an RTL model that continues where harts stopped: code at
+// addr loads one double word of each of the warm_lines() of its hart,
+// which brings them into the caches, then loads the registers and pc of
+// the hart from the save area at addr + 256 (512 bytes per mhartid) and
+// mret's there in machine mode. The line lists follow the save areas.
+// Done harts and the ones not in harts park in a WFI loop. When entry,
+// where the boot rom jumps to, is not addr it gets a jump to addr.
+void func_boot_stub(uint64_t entry, uint64_t addr, const std::vector<func_hart>& harts);
+// bytes func_boot_stub() writes at addr, at most
+uint64_t func_boot_stub_size(const std::vector<func_hart>& harts);
+
+// 32 bit equivalent of a compressed instruction, 0 if it has none here
+uint32_t func_expand(uint32_t c);
+
+#endif
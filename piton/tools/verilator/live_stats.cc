@@ -0,0 +1,251 @@
+/*
+Copyright (c) 2019 Princeton University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Princeton University nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY PRINCETON UNIVERSITY "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL PRINCETON UNIVERSITY BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "live_stats.h"
+#include "svdpi.h"
+#include "verilated.h"
+#include <iostream>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+// DPI, called by manycore_top in every cycle a flit crosses the chip/chipset
+// boundary. Bits [2:0] are the valids of the planes 1..3 to the chipset,
+// bits [5:3] the ones to the chip.
+extern "C" void sim_flits(const svBitVecVal* valid);
+
+namespace {
+
+live_segment local;          // without a segment the counters go here
+live_segment* live = &local;
+char seg_name[64];
+pid_t owner = 0;
+bool at_exit_set = false;
+uint64_t period = 10000;
+uint64_t next_cycle = 0;
+uint64_t last_cycle = 0;
+double last_wall = 0;
+const unsigned long long no_accesses = 0;
+const unsigned long long* mem_reads = &no_accesses;
+const unsigned long long* mem_writes = &no_accesses;
+unsigned long long mem_reads_base = 0, mem_writes_base = 0;
+
+double now(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void write_begin() {
+    live->seq++;
+    __sync_synchronize();
+}
+
+void write_end() {
+    __sync_synchronize();
+    live->seq++;
+}
+
+void update(uint64_t cycle) {
+    double wall = now(CLOCK_MONOTONIC);
+    write_begin();
+    if (wall > last_wall && cycle >= last_cycle) {
+        live->cycles_per_s = (cycle - last_cycle) / (wall - last_wall);
+    }
+    live->wall_s = now(CLOCK_REALTIME) - live->start;
+    live->cycle = cycle;
+    live->mem_reads = *mem_reads - mem_reads_base;
+    live->mem_writes = *mem_writes - mem_writes_base;
+    write_end();
+    last_cycle = cycle;
+    last_wall = wall;
+}
+
+void detach() {
+    if (live != &local) {
+        munmap(live, sizeof(live_segment));
+        live = &local;
+    }
+}
+
+// a forked child still maps the segment of its parent, only the owner
+// removes it
+void at_exit() {
+    if (owner == getpid()) {
+        detach();
+        shm_unlink(seg_name);
+        owner = 0;
+    }
+}
+
+void attach() {
+    snprintf(seg_name, sizeof(seg_name), "/" LIVE_PREFIX "%d", (int)getpid());
+    int fd = shm_open(seg_name, O_CREAT | O_RDWR | O_TRUNC, 0644);
+    if (fd < 0 || ftruncate(fd, sizeof(live_segment))) {
+        std::cout << "Warning: can not create the live statistics segment " << seg_name << std::endl;
+        if (fd >= 0) {
+            close(fd);
+            shm_unlink(seg_name);
+        }
+        return;
+    }
+    void* p = mmap(NULL, sizeof(live_segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        shm_unlink(seg_name);
+        return;
+    }
+    live = (live_segment*)p;
+    owner = getpid();
+    if (!at_exit_set) {
+        atexit(at_exit);
+        at_exit_set = true;
+    }
+}
+
+}  // namespace
+
+void live_stats_init() {
+    if (owner != getpid()) {
+        detach();
+        if (!Verilated::commandArgsPlusMatch("nolive_stats")[0]) {
+            attach();
+        }
+    }
+    const char* arg = Verilated::commandArgsPlusMatch("live_period=");
+    if (arg[0]) {
+        period = strtoull(arg + strlen("+live_period="), NULL, 0);
+    }
+
+    // batch runs call this again for every test, the memory counters are
+    // never cleared
+    write_begin();
+    live->version = LIVE_VERSION;
+    live->pid = getpid();
+    live->cores = 0;
+    live->status = -1;
+    if (!getcwd(live->dir, sizeof(live->dir))) {
+        live->dir[0] = '\0';
+    }
+    live->phase[0] = '\0';
+    live->start = now(CLOCK_REALTIME);
+    live->wall_s = 0;
+    live->cycle = 0;
+    live->cycles_per_s = 0;
+    live->mem_reads = live->mem_writes = 0;
+    for (int p = 0; p < LIVE_PLANES; p++) {
+        live->flits[p][LIVE_TO_CHIPSET] = live->flits[p][LIVE_TO_CHIP] = 0;
+    }
+    for (int i = 0; i < LIVE_MAX_CORES; i++) {
+        live->retired[i] = 0;
+    }
+    live->magic = LIVE_MAGIC;
+    write_end();
+    mem_reads_base = *mem_reads;
+    mem_writes_base = *mem_writes;
+    last_cycle = 0;
+    last_wall = now(CLOCK_MONOTONIC);
+    next_cycle = period;
+}
+
+void live_stats_phase(const char* name, uint64_t cycle) {
+    write_begin();
+    strncpy(live->phase, name, sizeof(live->phase) - 1);
+    live->phase[sizeof(live->phase) - 1] = '\0';
+    write_end();
+    update(cycle);
+}
+
+void live_stats_cycle(uint64_t cycle) {
+    if (cycle < next_cycle || !period) {
+        return;
+    }
+    update(cycle);
+    next_cycle = cycle + period;
+}
+
+void live_stats_finish(uint64_t cycle, int status) {
+    write_begin();
+    live->status = status;
+    write_end();
+    live_stats_phase("finished", cycle);
+}
+
+void live_stats_retired(int cores, const uint32_t* done) {
+    if (cores > LIVE_MAX_CORES) {
+        cores = LIVE_MAX_CORES;
+    }
+    bool writing = false;
+    for (int w = 0; w * 32 < cores; w++) {
+        if (!done[w]) {
+            continue;
+        }
+        // most cycles retire nothing and skip the seq
+        if (!writing) {
+            write_begin();
+            writing = true;
+        }
+        for (int i = w * 32; i < cores && i < w * 32 + 32; i++) {
+            if ((done[w] >> (i & 31)) & 1) {
+                live->retired[i]++;
+                if ((uint32_t)i >= live->cores) {
+                    live->cores = i + 1;
+                }
+            }
+        }
+    }
+    if (writing) {
+        write_end();
+    }
+}
+
+void live_stats_memory(const unsigned long long* reads, const unsigned long long* writes) {
+    mem_reads = reads;
+    mem_writes = writes;
+    mem_reads_base = *reads;
+    mem_writes_base = *writes;
+}
+
+void sim_flits(const svBitVecVal* valid) {
+    if (!(valid[0] & ((1u << 2 * LIVE_PLANES) - 1))) {
+        return;
+    }
+    write_begin();
+    for (int p = 0; p < LIVE_PLANES; p++) {
+        if ((valid[0] >> p) & 1) {
+            live->flits[p][LIVE_TO_CHIPSET]++;
+        }
+        if ((valid[0] >> (p + LIVE_PLANES)) & 1) {
+            live->flits[p][LIVE_TO_CHIP]++;
+        }
+    }
+    write_end();
+}
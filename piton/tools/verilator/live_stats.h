@@ -0,0 +1,94 @@
+/*
+Copyright (c) 2019 Princeton University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Princeton University nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY PRINCETON UNIVERSITY "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL PRINCETON UNIVERSITY BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Live statistics of a running Verilator simulation in shared memory.
+//
+// Every harness process publishes a POSIX shared memory segment
+// /pitonsim.<pid> (/dev/shm/pitonsim.<pid> on Linux) and refreshes it
+// while it runs, pitontop (tools/src/pitontop) attaches to the segments
+// of all simulations of the machine. Run time plusargs
+//   +nolive_stats        do not publish the segment
+//   +live_period=N       refresh the cycle, speed and memory counters
+//                        every N cycles (default 10000)
+// The retired instruction and flit counters are updated when they happen,
+// the flits by the sim_flits() DPI function of manycore_top.
+// The writer wraps every update, these counters included, in seq, odd
+// while it writes, a reader copies the segment until it sees the same
+// even seq before and after. The segment is removed when the process
+// exits, pitontop removes the ones left by killed processes.
+
+#ifndef LIVE_STATS_H
+#define LIVE_STATS_H
+
+#include <stdint.h>
+
+#define LIVE_MAGIC     0x5054534cu  // "LSTP"
+#define LIVE_VERSION   1
+#define LIVE_PREFIX    "pitonsim."
+#define LIVE_MAX_CORES 256
+
+// NoC planes at the chip/chipset boundary and the two directions
+#define LIVE_PLANES     3
+#define LIVE_TO_CHIPSET 0
+#define LIVE_TO_CHIP    1
+
+struct live_segment {
+    uint32_t magic;
+    uint32_t version;
+    volatile uint32_t seq;
+    int32_t pid;
+    uint32_t cores;              // highest core that retired anything + 1
+    int32_t status;              // -1 while running, then the SIM_* result
+    char dir[256];               // working directory of the simulation
+    char phase[32];              // current sim_stats phase
+    double start;                // CLOCK_REALTIME of the first update
+    double wall_s;               // wall time since start at the last update
+    uint64_t cycle;              // core_ref_clk cycle at the last update
+    double cycles_per_s;         // over the last refresh period
+    uint64_t mem_reads;          // memory model accesses, see live_stats_memory()
+    uint64_t mem_writes;
+    volatile uint64_t flits[LIVE_PLANES][2];
+    volatile uint64_t retired[LIVE_MAX_CORES];
+};
+
+// harness side, live_stats.cc
+
+// create the segment of this process, or clear it for the next test of a
+// batch run. A forked child calls it again to get its own segment.
+void live_stats_init();
+// name of the current phase
+void live_stats_phase(const char* name, uint64_t cycle);
+// called every cycle, refreshes the segment every +live_period cycles
+void live_stats_cycle(uint64_t cycle);
+// the simulation ended with status, the segment stays until exit
+void live_stats_finish(uint64_t cycle, int status);
+// count the retired instructions of the cores set in the bit vector done
+void live_stats_retired(int cores, const uint32_t* done);
+// counters of the memory model accesses to publish, none by default
+void live_stats_memory(const unsigned long long* reads, const unsigned long long* writes);
+
+#endif
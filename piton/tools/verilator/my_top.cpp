@@ -26,17 +26,158 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 #include "Vcmp_top.h"
 #include "verilated.h"
+#include "sim_stats.h"
+#include "live_stats.h"
+#include "clock_sched.h"
+#include "iob_sim.h"
+#include "svdpi.h"
 #include <iostream>
-#ifdef VERILATOR_VCD
+#include <fstream>
+#include <sstream>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#ifdef VL_THREADED
+#include <thread>
+#endif
+#if defined(VERILATOR_FST)
+#include "verilated_fst_c.h"
+#define VERILATOR_TRACE
+typedef VerilatedFstC VerilatedTraceC;
+#define TRACE_FILE "my_top.fst"
+#elif defined(VERILATOR_VCD)
 #include "verilated_vcd_c.h"
+#define VERILATOR_TRACE
+typedef VerilatedVcdC VerilatedTraceC;
+#define TRACE_FILE "my_top.vcd"
+#endif
+#ifdef VERILATOR_SAVABLE
+#include "verilated_save.h"
+#endif
+#ifdef COMMIT_TRACE
+#include "commit_trace.h"
+#endif
+#ifdef SAMPLED_SIM
+#include "func_model.h"
+#include <algorithm>
+#include <math.h>
 #endif
 
+extern "C" void set_tg_seed(unsigned int seed);
+
+// Exit codes of Vcmp_top. The verilog monitors report pass, fail and
+// their own max_cycle timeout through sim_result(), the harness adds
+//   +max_cycles=N        stop with SIM_TIMEOUT at core_ref_clk cycle N
+//   +deadlock_cycles=N   stop with SIM_DEADLOCK when no instruction has
+//                        retired for N cycles (see sim_progress())
+// A $finish without a result is reported as SIM_FAIL.
+#define SIM_PASS     0
+#define SIM_FAIL     1
+#define SIM_TIMEOUT  2
+#define SIM_DEADLOCK 3
+
+// Batch mode, +batch_file=NAME runs the tests listed in NAME back to back
+// in this process. Each line is
+//   <mem image> <diag.ev> [+plusarg ...]
+// where the plusargs only apply to that test and win over the ones of the
+// command line. The memory and iob model are reloaded for every test. A
+// model built with -vlt_savable is kept: a test with the same plusargs as
+// the one before starts from the reset snapshot of that test (see
+// reset_save()), other tests get a new model, so initial blocks see their
+// plusargs. Batch mode defaults to +sram_backdoor_init unless
+// +sram_init_cycles is given. One JSON line per test, with the time it
+// took to get out of reset, goes to +batch_results=NAME (default
+// my_top_batch.jsonl), the exit code is SIM_PASS only if all tests passed. The statistics of test
+// N go to my_top_stats_N.json and iob_stats_N.json(l), or to names made
+// the same way from +stats_file and +iob_stats_file, unless the line of
+// the test names them.
+std::string mem_file = "mem.image";
+std::string ev_file = "diag.ev";
+
 uint64_t main_time = 0; // Current simulation time
 uint64_t clk = 0;
 Vcmp_top* top;
+
+// Clock domains, see clock_sched.h. core_ref_clk is domain 0 with a period
+// of 500, main_time / 500 is its cycle, and tick() runs one such cycle.
+// Built with VLT_CLOCK_DOMAINS the chipset, memory, SPI, passthru and
+// JTAG clocks of manycore_top are top ports as well. The RTL registers
+// the ones its configuration connects with sim_clock(), at the periods of
+// the simulated clocks relative to the 1000MHz core_ref_clk, and every
+// edge of any domain is one eval. Otherwise the chipset runs on
+// core_ref_clk.
+//   +clk_<name>=P        period P of a clock, in the units of main_time
+//   +clk_<name>=P:PH     and the time PH of its first rising edge
+//   +clk_<name>=0        gate the clock off for the whole run
+// sim_clock_gate() stops and restarts a domain while the model runs.
+clock_sched clocks;
+#ifdef VERILATOR_TRACE
+// Trace window in core_ref_clk cycles, set from the plusargs
+//   +notrace             do not trace at all
+//   +trace_start=N       open the trace file at cycle N (default 0)
+//   +trace_stop=N        close it at cycle N (default never)
+//   +trace_depth=N       hierarchy levels below cmp_top (default 99)
+//   +trace_file=NAME     output file (default my_top.vcd / my_top.fst)
+VerilatedTraceC* tfp = NULL;
+uint64_t trace_start = 0;
+uint64_t trace_stop = ~0ULL;
+std::string trace_file = TRACE_FILE;
+#endif
 #ifdef VERILATOR_VCD
-VerilatedVcdC* tfp;
+// Failure trace, +trace_ring=N keeps the trace of the last N to 2N cycles
+// in memory instead of writing it, from +trace_start on. Only a run that
+// does not pass writes it out, as +trace_ring_file=NAME (default
+// my_top_fail) .fst when vcd2fst is found, .vcd otherwise. The ring holds
+// two segments, each starting with a full dump of all signals; what is
+// traced is chosen with +trace_depth.
+class trace_ring : public VerilatedVcdFile {
+public:
+    std::string header;
+    std::string seg[2];
+    int cur;
+    trace_ring() : cur(0) {}
+    virtual bool open(const std::string& name) {
+        cur ^= 1;
+        seg[cur].clear();
+        return true;
+    }
+    virtual void close() {}
+    virtual ssize_t write(const char* bufp, ssize_t len) {
+        seg[cur].append(bufp, len);
+        return len;
+    }
+};
+
+trace_ring* ring = NULL;
+uint64_t ring_cycles = 0;
+uint64_t ring_next = 0;
 #endif
+#ifdef VERILATOR_SAVABLE
+// Checkpoints, the model goes to NAME and the iob/memory model to NAME.iob
+//   +save_cycle=N        save once core_ref_clk cycle N is reached
+//   +save_file=NAME      checkpoint to write (default my_top.ckpt)
+//   +save_exit           stop the run after saving
+//   +restore_file=NAME   start from a checkpoint instead of reset
+bool save_pending = false;
+uint64_t save_cycle = 0;
+std::string save_file = "my_top.ckpt";
+
+// Reset snapshot, the model just before ok_iob and the iob state at that
+// time, kept in reset_file. Runs that reset the model the same way (same
+// plusargs, test_key) rewind to it instead of building and resetting a new
+// model; the memory image and diag.ev are loaded fresh.
+bool reset_snapshot = false;
+std::string reset_file;
+std::string reset_key;
+#endif
+std::string test_key;
+bool test_reused = false;
+double test_setup_s = 0;
 // This is a 64-bit integer to reduce wrap over issues and
 // // allow modulus. You can also use a double, if you wish.
 double sc_time_stamp () { // Called by $time in Verilog
@@ -44,18 +185,639 @@ return main_time; // converts to double, to match
 // what SystemC does
 }
 
-void tick() {
-    top->core_ref_clk = !top->core_ref_clk;
-    main_time += 250;
+uint64_t plusarg_u64(const char* name, uint64_t def) {
+    std::string match = std::string(name) + "=";
+    const char* arg = Verilated::commandArgsPlusMatch(match.c_str());
+    if (!arg[0]) {
+        return def;
+    }
+    return strtoull(arg + match.size() + 1, NULL, 0);
+}
+
+#ifdef VLT_CLOCK_DOMAINS
+struct clock_port {
+    const char* name;
+    CData Vcmp_top::* sig;
+};
+
+static const clock_port clock_ports[] = {
+    { "chipset_clk", &Vcmp_top::chipset_clk },
+    { "chipset_clk_osc_p", &Vcmp_top::chipset_clk_osc_p },
+    { "chipset_clk_osc", &Vcmp_top::chipset_clk_osc },
+    { "mem_clk", &Vcmp_top::mem_clk },
+    { "spi_sys_clk", &Vcmp_top::spi_sys_clk },
+    { "passthru_clk_osc_p", &Vcmp_top::passthru_clk_osc_p },
+    { "passthru_chipset_clk_p", &Vcmp_top::passthru_chipset_clk_p },
+    { "jtag_clk", &Vcmp_top::jtag_clk },
+};
+
+// DPI, called by the initial block of manycore_top for every clock the
+// configuration uses
+extern "C" void sim_clock(const char* name, int period) {
+    const clock_port* port = NULL;
+    for (size_t i = 0; i < sizeof(clock_ports) / sizeof(clock_ports[0]); i++) {
+        if (!strcmp(clock_ports[i].name, name)) {
+            port = &clock_ports[i];
+        }
+    }
+    if (!port) {
+        std::cout << "Warning: sim_clock() of unknown clock " << name << std::endl;
+        return;
+    }
+    if (clocks.find(name) >= 0) {
+        return;
+    }
+    std::string arg = "clk_" + std::string(name) + "=";
+    const char* value = Verilated::commandArgsPlusMatch(arg.c_str());
+    uint64_t phase = 0;
+    if (value[0]) {
+        char* end;
+        period = strtoull(value + arg.size() + 1, &end, 0);
+        if (*end == ':') {
+            phase = strtoull(end + 1, NULL, 0);
+        }
+    }
+    int domain = clocks.add(name, &(top->*port->sig), period ? period : 500, phase);
+    if (!period) {
+        clocks.gate(domain, true);
+    }
+}
+
+// DPI, off stops the clock low, see clock_sched.h
+extern "C" void sim_clock_gate(const char* name, int off) {
+    int domain = clocks.find(name);
+    if (domain > 0) {
+        clocks.gate(domain, off);
+    }
+}
+#endif
+
+// The clocks of a new model, before reset or a restore
+void clocks_init() {
+    clocks.clear(main_time);
+    clocks.add("core_ref_clk", &top->core_ref_clk, 500, 250);
+#ifdef VLT_CLOCK_DOMAINS
+    // the initial blocks register the other clocks
     top->eval();
+#endif
+}
+
+// The command line of the process plus the plusargs left in words, used
+// for the tests of a batch and the children of a fork. The first match of
+// a plusarg counts, the ones of the test go before the command line.
+std::vector<std::string> main_args;
+
+void set_test_args(std::istream& words) {
+    std::vector<std::string> args(main_args.begin(), main_args.begin() + 1);
+    std::string word;
+    while (words >> word) {
+        args.push_back(word);
+    }
+    args.insert(args.end(), main_args.begin() + 1, main_args.end());
+    std::vector<const char*> argv;
+    for (size_t i = 0; i < args.size(); i++) {
+        argv.push_back(args[i].c_str());
+    }
+    Verilated::commandArgs(argv.size(), &argv[0]);
+}
+
+#ifdef VERILATOR_TRACE
+void trace_init() {
+    if (Verilated::commandArgsPlusMatch("notrace")[0]) {
+        return;
+    }
+    trace_start = plusarg_u64("trace_start", 0);
+    trace_stop = plusarg_u64("trace_stop", ~0ULL);
+    const char* arg = Verilated::commandArgsPlusMatch("trace_file=");
+    trace_file = arg[0] ? arg + strlen("+trace_file=") : TRACE_FILE;
+
 #ifdef VERILATOR_VCD
-    tfp->dump(main_time);
+    ring_cycles = plusarg_u64("trace_ring", 0);
+    if (ring_cycles) {
+        arg = Verilated::commandArgsPlusMatch("trace_ring_file=");
+        trace_file = arg[0] ? arg + strlen("+trace_ring_file=") : "my_top_fail";
+        trace_stop = ~0ULL;
+        ring = new trace_ring;
+        tfp = new VerilatedTraceC(ring);
+        top->trace(tfp, plusarg_u64("trace_depth", 99));
+        std::cout << "Keeping the last " << ring_cycles << " cycles of trace from cycle "
+                  << trace_start << " for a failing run" << std::endl;
+        return;
+    }
 #endif
-    top->core_ref_clk = !top->core_ref_clk;
-    main_time += 250;
-    top->eval();
+    tfp = new VerilatedTraceC;
+    top->trace(tfp, plusarg_u64("trace_depth", 99));
+    std::cout << "Tracing cycles " << trace_start << " to " << trace_stop
+              << " into " << trace_file << std::endl;
+}
+
+// Open and close the trace file at the window edges, nothing is
+// dumped outside of it so the run goes at full speed until then.
+void trace_window() {
+    uint64_t cycle = main_time / 500;
+    if (!tfp) {
+        return;
+    }
+    if (!tfp->isOpen() && cycle >= trace_start && cycle < trace_stop) {
+        tfp->open(trace_file.c_str());
+#ifdef VERILATOR_VCD
+        if (ring) {
+            // only the declarations so far, every segment needs them
+            ring->header.swap(ring->seg[ring->cur]);
+            ring_next = cycle + ring_cycles;
+        }
+    } else if (ring && cycle >= ring_next) {
+        // start the other segment with a full dump
+        tfp->openNext(false);
+        ring_next = cycle + ring_cycles;
+#endif
+    } else if (tfp->isOpen() && cycle >= trace_stop) {
+        tfp->close();
+        delete tfp;
+        tfp = NULL;
+    }
+}
+
+void trace_dump() {
+    if (tfp && tfp->isOpen()) {
+        tfp->dump(main_time);
+    }
+}
+#endif
+
 #ifdef VERILATOR_VCD
-    tfp->dump(main_time);
+void trace_ring_write() {
+    if (!tfp->isOpen()) {
+        return;
+    }
+    tfp->flush();
+    std::string vcd = trace_file + ".vcd";
+    std::string fst = trace_file + ".fst";
+    FILE* fp = fopen(vcd.c_str(), "w");
+    if (!fp) {
+        std::cout << "Error: can not write " << vcd << std::endl;
+        return;
+    }
+    fwrite(ring->header.data(), 1, ring->header.size(), fp);
+    fwrite(ring->seg[ring->cur ^ 1].data(), 1, ring->seg[ring->cur ^ 1].size(), fp);
+    fwrite(ring->seg[ring->cur].data(), 1, ring->seg[ring->cur].size(), fp);
+    fclose(fp);
+    std::string cmd = "vcd2fst " + vcd + " " + fst + " > /dev/null 2>&1";
+    if (system(cmd.c_str()) == 0) {
+        remove(vcd.c_str());
+        vcd = fst;
+    }
+    std::cout << "Wrote the failure trace to " << vcd << std::endl;
+}
+#endif
+
+#ifdef VERILATOR_SAVABLE
+void save_model(const std::string& file) {
+    VerilatedSave os;
+    os.open(file.c_str());
+    os << main_time;
+    os << *top;
+    os.close();
+    if (iob_model_save((file + ".iob").c_str())) {
+        exit(1);
+    }
+    std::cout << "Saved " << file << " at cycle " << main_time / 500 << std::endl;
+}
+
+// The iob model still reads diag.ev itself, the checkpoint only carries
+// the memory, the queued packets and the event counters.
+void restore_model(const std::string& file) {
+    iob_model_init((char *) mem_file.c_str(), (char *) ev_file.c_str(), 0);
+    VerilatedRestore os;
+    os.open(file.c_str());
+    os >> main_time;
+    os >> *top;
+    os.close();
+    clocks.resync(main_time);
+    if (iob_model_restore((file + ".iob").c_str())) {
+        exit(1);
+    }
+    std::cout << "Restored " << file << " at cycle " << main_time / 500 << std::endl;
+}
+
+void reset_save() {
+    reset_file = "my_top_reset.ckpt";
+    reset_key = test_key;
+    VerilatedSave os;
+    os.open(reset_file.c_str());
+    os << main_time;
+    os << *top;
+    os.close();
+    if (iob_model_save_state((reset_file + ".iob").c_str())) {
+        exit(1);
+    }
+}
+
+// The model can be rewound when it exists, was snapshot with the same
+// plusargs and is not traced, trace() only works on a new model.
+bool reset_usable() {
+#ifdef VERILATOR_TRACE
+    if (!Verilated::commandArgsPlusMatch("notrace")[0]) {
+        return false;
+    }
+#endif
+    return reset_snapshot && top && !reset_file.empty() && reset_key == test_key;
+}
+
+void reset_restore() {
+    VerilatedRestore os;
+    os.open(reset_file.c_str());
+    os >> main_time;
+    os >> *top;
+    os.close();
+    clocks.resync(main_time);
+    if (iob_model_restore_state((reset_file + ".iob").c_str())) {
+        exit(1);
+    }
+}
+
+void reset_remove() {
+    if (!reset_file.empty()) {
+        remove(reset_file.c_str());
+        remove((reset_file + ".iob").c_str());
+        reset_file.clear();
+    }
+}
+
+void save_init() {
+    const char* arg = Verilated::commandArgsPlusMatch("save_file=");
+    save_file = arg[0] ? arg + strlen("+save_file=") : "my_top.ckpt";
+    save_pending = Verilated::commandArgsPlusMatch("save_cycle=")[0];
+    save_cycle = plusarg_u64("save_cycle", 0);
+}
+
+void save_check() {
+    if (save_pending && main_time / 500 >= save_cycle) {
+        save_pending = false;
+        save_model(save_file);
+        if (Verilated::commandArgsPlusMatch("save_exit")[0]) {
+            Verilated::gotFinish(true);
+        }
+    }
+}
+#endif
+
+int sim_status = -1;
+uint64_t last_progress = 0;
+uint64_t max_cycles = 0;
+uint64_t deadlock_cycles = 0;
+
+// DPI, the first result reported wins.
+extern "C" void sim_result(int status) {
+    if (sim_status < 0) {
+        sim_status = status;
+    }
+}
+
+// DPI, called by pc_cmp in every cycle an instruction retires, done has
+// a bit for each of the tiles cores.
+extern "C" void sim_progress(int tiles, const svBitVecVal* done) {
+    last_progress = main_time / 500;
+    live_stats_retired(tiles, done);
+}
+
+const char* sim_status_name(int status) {
+    static const char* names[] = { "PASS", "FAIL", "TIMEOUT", "DEADLOCK" };
+    return status >= SIM_PASS && status <= SIM_DEADLOCK ? names[status] : "FAIL";
+}
+
+void watchdog_init() {
+    max_cycles = plusarg_u64("max_cycles", 0);
+    deadlock_cycles = plusarg_u64("deadlock_cycles", 0);
+    last_progress = main_time / 500;
+}
+
+// true when the run has to be stopped.
+bool watchdog_check() {
+    uint64_t cycle = main_time / 500;
+    if (max_cycles && cycle >= max_cycles) {
+        std::cout << cycle << " : Simulation -> TIMEOUT (max_cycles = "
+                  << max_cycles << ")" << std::endl;
+        sim_result(SIM_TIMEOUT);
+        return true;
+    }
+    if (deadlock_cycles && cycle - last_progress >= deadlock_cycles) {
+        std::cout << cycle << " : Simulation -> DEADLOCK (no instruction retired since cycle "
+                  << last_progress << ")" << std::endl;
+        sim_result(SIM_DEADLOCK);
+        return true;
+    }
+    return false;
+}
+
+#ifdef IDLE_FAST_FORWARD
+// Quiescence fast-forward, +fast_forward turns it on. manycore_top calls
+// sim_idle() in every cycle all cores sleep in WFI with no traffic to the
+// chipset and no timer interrupt pending. After +ff_min_idle=N (default
+// 1000) such cycles in a row the rtc ticks up to the next timer wake-up
+// are skipped: the clint's mtime is advanced through sim_skip_rtc() and
+// main_time jumps by the same amount. The rtc is core_ref_clk / 128.
+// Cycle counters inside the cores do not see the skipped cycles.
+#define RTC_DIV 128
+extern "C" void sim_skip_rtc(long long rtc_ticks);
+
+bool ff_on = false;
+uint64_t ff_min_idle = 1000;
+uint64_t ff_idle_cycle = 0;
+uint64_t ff_idle_run = 0;
+uint64_t ff_rtc_ticks = 0;
+uint64_t ff_skipped = 0;
+
+// DPI, rtc ticks left until the next timer interrupt.
+extern "C" void sim_idle(long long rtc_ticks) {
+    uint64_t cycle = main_time / 500;
+    ff_idle_run = (ff_idle_cycle + 1 == cycle) ? ff_idle_run + 1 : 1;
+    ff_idle_cycle = cycle;
+    ff_rtc_ticks = rtc_ticks;
+}
+
+void fast_forward_init() {
+    ff_on = Verilated::commandArgsPlusMatch("fast_forward")[0];
+    ff_min_idle = plusarg_u64("ff_min_idle", 1000);
+    ff_idle_cycle = ff_idle_run = ff_skipped = 0;
+}
+
+void fast_forward_check() {
+    // keep two ticks so the wake-up itself is simulated
+    if (!ff_on || ff_idle_cycle != main_time / 500 ||
+        ff_idle_run < ff_min_idle || ff_rtc_ticks <= 2) {
+        return;
+    }
+    uint64_t ticks = ff_rtc_ticks - 2;
+    svSetScope(svGetScopeFromName("TOP.cmp_top"));
+    sim_skip_rtc(ticks);
+    main_time += ticks * RTC_DIV * 500;
+    clocks.skip(ticks * RTC_DIV * 500);
+    ff_skipped += ticks * RTC_DIV;
+    ff_idle_run = 0;
+    last_progress = main_time / 500;
+    std::cout << main_time / 500 << " : fast-forward " << ticks * RTC_DIV
+              << " idle cycles (" << ff_skipped << " in total)" << std::endl;
+}
+#endif
+
+// Fork after boot, +fork_file=NAME runs the boot once and fans out at
+// core_ref_clk cycle +fork_cycle=N. Each line of NAME is
+//   <mem image> [+plusarg ...]
+// and becomes a child process in fork_<i>/ that patches the image into
+// the memory model (copy-on-write, the parent's memory is untouched)
+// and runs on with the extra plusargs. Only harness plusargs can still
+// change, the model's initial blocks ran before the fork, and the image
+// has to be loaded before the cores or caches touched its lines. At most
+// +fork_jobs=J (default all cores) children run at once, their results
+// go to my_top_fork.jsonl and the parent passes only if all of them do.
+bool fork_pending = false;
+uint64_t fork_cycle = 0;
+std::string fork_list;
+
+void fork_init() {
+    const char* arg = Verilated::commandArgsPlusMatch("fork_file=");
+    fork_pending = arg[0];
+    if (!fork_pending) {
+        return;
+    }
+    fork_list = arg + strlen("+fork_file=");
+    fork_cycle = plusarg_u64("fork_cycle", main_time / 500);
+#ifdef VLT_THREADS
+    // the model's worker threads do not survive fork()
+    std::cout << "Error: +fork_file needs a model built without -vlt_threads" << std::endl;
+    sim_result(SIM_FAIL);
+    Verilated::gotFinish(true);
+#endif
+}
+
+// Child side, true when the child can not start its workload.
+bool fork_child(int num, std::string& image, std::istream& words) {
+    char dir[32];
+    snprintf(dir, sizeof(dir), "fork_%d", num);
+    if (iob_model_load((char *) image.c_str()) ||
+        (mkdir(dir, 0777) && errno != EEXIST) || chdir(dir) ||
+        !freopen("sim.log", "w", stdout) || dup2(fileno(stdout), fileno(stderr)) < 0) {
+        return true;
+    }
+    iob_model_fork();
+    std::cout << main_time / 500 << " : fork child " << num << " running " << image << std::endl;
+#ifdef VERILATOR_TRACE
+    // an open trace file is shared with the parent, leave it to the parent,
+    // the failure trace ring is memory and the child has its own copy
+    bool shared_trace = tfp && tfp->isOpen();
+#ifdef VERILATOR_VCD
+    shared_trace = shared_trace && !ring;
+#endif
+    if (shared_trace) {
+        tfp = NULL;
+    }
+#endif
+    set_test_args(words);
+    watchdog_init();
+#ifdef COMMIT_TRACE
+    commit_trace_init();
+#endif
+    // the parent keeps its segment, the child publishes its own
+    live_stats_init();
+    sim_stats_phase("workload", main_time / 500);
+    return false;
+}
+
+// Parent side, runs the children and collects their exit codes. Returns
+// in the children with their workload loaded.
+void fork_check() {
+    if (!fork_pending || main_time / 500 < fork_cycle) {
+        return;
+    }
+    fork_pending = false;
+    std::ifstream in(fork_list.c_str());
+    if (!in) {
+        std::cout << "Error: can not open fork file " << fork_list << std::endl;
+        sim_result(SIM_FAIL);
+        Verilated::gotFinish(true);
+        return;
+    }
+    FILE* fp = fopen("my_top_fork.jsonl", "w");
+    uint64_t jobs = plusarg_u64("fork_jobs", sysconf(_SC_NPROCESSORS_ONLN));
+    std::vector<std::string> images;
+    std::vector<pid_t> pids;
+    std::string line;
+    bool eof = false;
+    uint64_t running = 0;
+    int failed = 0;
+    sim_stats_phase("fork", main_time / 500);
+#ifdef COMMIT_TRACE
+    // the writer thread does not survive fork(), each child starts its own
+    // trace in its fork_<n> directory
+    commit_trace_finish();
+#endif
+    std::cout << main_time / 500 << " : forking the workloads of " << fork_list << std::endl;
+
+    while (true) {
+        while (!eof && (running < jobs || !running)) {
+            std::string image;
+            if (!std::getline(in, line)) {
+                eof = true;
+                break;
+            }
+            std::istringstream words(line);
+            if (!(words >> image) || image[0] == '#') {
+                continue;
+            }
+            std::cout << std::flush;
+            fflush(NULL);
+            pid_t pid = fork();
+            if (pid == 0) {
+                if (fork_child(images.size(), image, words)) {
+                    std::cout << "Error: fork child " << images.size() << " could not load "
+                              << image << std::endl;
+                    exit(SIM_FAIL);
+                }
+                return;
+            }
+            if (pid < 0) {
+                std::cout << "Error: fork failed for " << image << std::endl;
+                failed++;
+            } else {
+                running++;
+            }
+            images.push_back(image);
+            pids.push_back(pid);
+        }
+        if (!running) {
+            break;
+        }
+        int wstatus;
+        pid_t pid = wait(&wstatus);
+        if (pid < 0) {
+            break;
+        }
+        running--;
+        for (size_t i = 0; i < pids.size(); i++) {
+            if (pids[i] != pid) {
+                continue;
+            }
+            int status = WIFEXITED(wstatus) ? WEXITSTATUS(wstatus) : SIM_FAIL;
+            std::cout << main_time / 500 << " : fork child " << i << " (" << images[i]
+                      << ") -> " << sim_status_name(status) << std::endl;
+            if (fp) {
+                fprintf(fp, "{\"child\":%d,\"mem_image\":\"%s\",\"result\":\"%s\",\"exit_code\":%d}\n",
+                        (int) i, images[i].c_str(), sim_status_name(status), status);
+                fflush(fp);
+            }
+            if (status != SIM_PASS) {
+                failed++;
+            }
+        }
+    }
+    if (fp) {
+        fclose(fp);
+    }
+    std::cout << "Fork: " << images.size() - failed << " of " << images.size()
+              << " workloads passed, results in my_top_fork.jsonl" << std::endl;
+    sim_result(failed || images.empty() ? SIM_FAIL : SIM_PASS);
+    Verilated::gotFinish(true);
+}
+
+#ifdef SAMPLED_SIM
+// Sampled simulation of bare-metal ariane workloads, +sample_period=N
+// runs the workload on the functional model (func_model.h) and every N
+// instructions per hart measures a detailed interval that starts from the
+// functional state. The model is built once: the first interval saves it
+// at the end of reset (the reset snapshot of +batch_file) and every other
+// one rewinds it there, all of them then boot from the boot stub:
+//   +sample_warm_lines=L lines of the functional run each hart touched
+//                        last that the boot stub loads into the caches
+//                        before it resumes the hart (default 256)
+//   +sample_warmup=C     cycles to warm up the pipeline after the boot
+//                        stub resumed the harts (default 500)
+//   +sample_detail=C     cycles measured after the warm-up (default 10000)
+//   +sample_boot=C       cycles the boot rom and stub may take (default
+//                        200000), an interval whose harts are not resumed
+//                        by then is dropped
+//   +sample_max=K        at most K intervals (default no limit), the
+//                        functional run still goes to the end
+//   +sample_instrs=N     stop after N instructions per hart (default never)
+//   +sample_harts=H      harts to run, mhartid 0 to H-1 (default 1)
+//   +sample_entry=ADDR   where the boot rom jumps to (default 0x80000000)
+//   +sample_stub=ADDR    boot stub, register save area and line lists,
+//                        required, it must not overlap the memory of the
+//                        workload, see func_boot_stub(), the 8 bytes at
+//                        +sample_entry become a jump to it
+//   +sample_results=NAME JSON summary (default my_top_sample.json)
+// A hart ends on ecall, ebreak, a +good_trapN/+bad_trapN pc or an
+// instruction the functional model does not have. Only the registers, the
+// pc and the warm lines move into the RTL, the branch predictors and
+// TLBs of an interval start cold and other CSRs start from reset. The
+// memory of the interval is thrown away afterwards, the functional model
+// goes on from its own.
+extern "C" long long sample_retired(int hart);
+extern "C" long long sample_pc(int hart);
+
+// iob checkpoint of the functional memory, empty outside of intervals
+std::string sample_ckpt;
+uint64_t sample_entry = 0x80000000ULL;
+uint64_t sample_stub = 0;
+std::vector<func_hart> sample_harts;
+
+// bytes func_boot_stub() writes at sample_stub
+uint64_t sample_stub_size() {
+    return func_boot_stub_size(sample_harts);
+}
+
+// The stub must not overwrite lines of the workload, checked against the
+// image and against the memory of every interval, which the workload may
+// have grown.
+bool sample_stub_free() {
+    int lines = iob_model_lines(sample_stub, sample_stub_size());
+    if (lines) {
+        std::cout << "Error: +sample_stub=0x" << std::hex << sample_stub << std::dec
+                  << " overlaps " << lines << " lines of the workload memory" << std::endl;
+    }
+    return !lines;
+}
+
+// The memory model of an interval model.
+void sample_memory_init() {
+    iob_model_init((char *) mem_file.c_str(), (char *) ev_file.c_str(), !sample_ckpt.empty());
+    if (sample_ckpt.empty()) {
+        return;
+    }
+    if (iob_model_restore(sample_ckpt.c_str()) || !sample_stub_free()) {
+        exit(SIM_FAIL);
+    }
+    func_boot_stub(sample_entry, sample_stub, sample_harts);
+}
+#endif
+
+// One core_ref_clk cycle, up to its falling edge. The model is evaluated
+// once for each time at which some clock has an edge.
+void tick() {
+#ifdef VERILATOR_TRACE
+    trace_window();
+#endif
+    do {
+        main_time = clocks.step();
+        top->eval();
+#ifdef VERILATOR_TRACE
+        trace_dump();
+#endif
+    } while (!clocks.fell(0));
+}
+
+// The memory and iob model of a test.
+void test_memory_init() {
+    // Seed the IOB model's delay generators, same plusarg as the PLI flow
+    const char* seed_arg = Verilated::commandArgsPlusMatch("tg_seed=");
+    if (seed_arg[0]) {
+        set_tg_seed(atoi(seed_arg + strlen("+tg_seed=")));
+    }
+
+#ifdef SAMPLED_SIM
+    sample_memory_init();
+#else
+    iob_model_init((char *) mem_file.c_str(), (char *) ev_file.c_str(), 0);
 #endif
 }
 
@@ -65,8 +827,7 @@ void reset_and_init() {
 //    stub_done = 4'b0;
 //    stub_pass = 4'b0;
 
-//    // Clocks initial value
-    top->core_ref_clk = 0;
+//    // Clocks initial value, see clocks_init()
 
 //    // Resets are held low at start of boot
     top->sys_rst_n = 0;
@@ -89,9 +850,10 @@ void reset_and_init() {
 
     top->async_mux = 0;
 
-    init_jbus_model_call((char *) "mem.image", 0);
+    test_memory_init();
 
     std::cout << "Before first ticks" << std::endl << std::flush;
+    sim_stats_phase("pll_reset", main_time / 500);
     tick();
     std::cout << "After very first tick" << std::endl << std::flush;
 //    // Reset PLL for 100 cycles
@@ -103,6 +865,7 @@ void reset_and_init() {
     top->pll_rst_n = 1;
 
     std::cout << "Before second ticks" << std::endl << std::flush;
+    sim_stats_phase("pll_lock", main_time / 500);
 //    // Wait for PLL lock
 //    wait( pll_lock == 1'b1 );
     while (!top->pll_lock) {
@@ -110,6 +873,7 @@ void reset_and_init() {
     }
 
     std::cout << "Before third ticks" << std::endl << std::flush;
+    sim_stats_phase("clk_en", main_time / 500);
 //    // After 10 cycles turn on chip-level clock enable
 //    repeat(10)@(posedge `CHIP_INT_CLK);
 //    clk_en = 1'b1;
@@ -122,6 +886,7 @@ void reset_and_init() {
 //    repeat(100)@(posedge `CHIP_INT_CLK);
 //    sys_rst_n = 1'b1;
 //    jtag_rst_l = 1'b1;
+    sim_stats_phase("sys_reset", main_time / 500);
     for (int i = 0; i < 100; i++) {
         tick();
     }
@@ -129,41 +894,560 @@ void reset_and_init() {
 
 //    // Wait for SRAM init, trin: 5000 cycles is about the lowest
 //    repeat(5000)@(posedge `CHIP_INT_CLK);
-    for (int i = 0; i < 5000; i++) {
+    // With +sram_backdoor_init the wait is only for the reset synchronizers:
+    // the generic sram models are zeroed by their initial blocks and the
+    // rf_l15_* files clear on rst_n. manycore_top checks at ok_iob that the
+    // chip is out of reset and that the srams are not the BIST cleared brams.
+    sim_stats_phase("sram_init", main_time / 500);
+    uint64_t sram_init_cycles = 5000;
+    if (Verilated::commandArgsPlusMatch("sram_backdoor_init")[0]) {
+        sram_init_cycles = 50;
+    }
+    sram_init_cycles = plusarg_u64("sram_init_cycles", sram_init_cycles);
+    for (uint64_t i = 0; i < sram_init_cycles; i++) {
         tick();
     }
 
 //    top->diag_done = 1;
 
+#ifdef VERILATOR_SAVABLE
+    if (reset_snapshot) {
+        reset_save();
+    }
+#endif
     //top->ciop_fake_iob.ok_iob = 1;
     top->ok_iob = 1;
     std::cout << "Reset complete" << std::endl << std::flush;
 }
 
-int main(int argc, char **argv, char **env) {
-std::cout << "Started" << std::endl << std::flush;
-Verilated::commandArgs(argc, argv);
-top = new Vcmp_top;
-std::cout << "Vcmp_top created" << std::endl << std::flush;
+#ifdef VERILATOR_SAVABLE
+// reset_and_init() of a model that can be rewound to its reset snapshot.
+void reset_from_snapshot() {
+    test_memory_init();
+    sim_stats_phase("reset_restore", main_time / 500);
+    reset_restore();
+    top->ok_iob = 1;
+    std::cout << "Reset restored from " << reset_file << std::endl << std::flush;
+}
+#endif
 
-#ifdef VERILATOR_VCD
-Verilated::traceEverOn(true);
-tfp = new VerilatedVcdC;
-top->trace (tfp, 99);
-tfp->open ("my_top.vcd");
+// One simulation from construction to $finish or a watchdog, returns the
+// exit code of the test.
+int run_test() {
+main_time = 0;
+sim_status = -1;
+Verilated::gotFinish(false);
+sim_stats_init();
+struct timespec setup_start, setup_end;
+clock_gettime(CLOCK_MONOTONIC, &setup_start);
+#ifdef VERILATOR_SAVABLE
+test_reused = reset_usable();
+#endif
+if (!test_reused) {
+    delete top;
+    sim_stats_phase("construct", 0);
+    top = new Vcmp_top;
+    std::cout << "Vcmp_top created" << std::endl << std::flush;
+    clocks_init();
+}
+#ifdef COMMIT_TRACE
+commit_trace_init();
+#endif
 
-Verilated::debug(1);
+#ifdef VERILATOR_TRACE
+trace_init();
 #endif
 
+#ifdef VERILATOR_SAVABLE
+save_init();
+const char* restore_arg = Verilated::commandArgsPlusMatch("restore_file=");
+if (restore_arg[0]) {
+    sim_stats_phase("restore", 0);
+    restore_model(restore_arg + strlen("+restore_file="));
+} else if (test_reused) {
+    reset_from_snapshot();
+} else {
+    reset_and_init();
+}
+save_check();
+#else
 reset_and_init();
+#endif
+clock_gettime(CLOCK_MONOTONIC, &setup_end);
+test_setup_s = (setup_end.tv_sec - setup_start.tv_sec) +
+               (setup_end.tv_nsec - setup_start.tv_nsec) * 1e-9;
 
-while (!Verilated::gotFinish()) { tick(); }
+sim_stats_phase("workload", main_time / 500);
+watchdog_init();
+fork_init();
+#ifdef IDLE_FAST_FORWARD
+fast_forward_init();
+#endif
+while (!Verilated::gotFinish() && !watchdog_check()) {
+    tick();
+#ifdef VERILATOR_SAVABLE
+    save_check();
+#endif
+#ifdef IDLE_FAST_FORWARD
+    fast_forward_check();
+#endif
+    fork_check();
+    sim_stats_cycle(main_time / 500);
+}
+sim_stats_finish(main_time / 500);
+if (clocks.domains().size() > 1) {
+    clocks.report(std::cout);
+}
+int status = sim_status < 0 ? SIM_FAIL : sim_status;
+live_stats_finish(main_time / 500, status);
+#ifdef COMMIT_TRACE
+commit_trace_finish();
+#endif
 
 #ifdef VERILATOR_VCD
-std::cout << "Trace done" << std::endl;
-tfp->close();
+if (ring) {
+    if (status != SIM_PASS) {
+        trace_ring_write();
+    }
+    delete tfp;
+    delete ring;
+    tfp = NULL;
+    ring = NULL;
+}
+#endif
+#ifdef VERILATOR_TRACE
+if (tfp) {
+    if (tfp->isOpen()) {
+        std::cout << "Trace done" << std::endl;
+        tfp->close();
+    }
+    delete tfp;
+    tfp = NULL;
+}
 #endif
 
+#ifdef VERILATOR_SAVABLE
+if (!reset_snapshot) {
+    delete top;
+    top = NULL;
+}
+#else
 delete top;
-exit(0);
+top = NULL;
+#endif
+iob_model_done();
+return status;
+}
+
+#ifdef SAMPLED_SIM
+// +good_trapN= and +bad_trapN= pcs of pc_cmp, in hex without 0x
+void sample_traps(const char* name, std::vector<uint64_t>& pcs) {
+    for (int i = 0; i < 32; i++) {
+        std::ostringstream match;
+        match << name << i << "=";
+        const char* arg = Verilated::commandArgsPlusMatch(match.str().c_str());
+        if (arg[0]) {
+            pcs.push_back(strtoull(arg + match.str().size() + 1, NULL, 16));
+        }
+    }
+}
+
+// Runs every hart that is not done for steps instructions, round robin.
+// Returns false once all harts are done, status turns SIM_FAIL when one
+// of them ended badly.
+bool sample_advance(uint64_t steps, uint64_t limit, const std::vector<uint64_t>& good,
+                    const std::vector<uint64_t>& bad, int& status) {
+    bool active = false;
+    for (uint64_t n = 0; n < steps; n++) {
+        active = false;
+        for (size_t h = 0; h < sample_harts.size(); h++) {
+            func_hart& hart = sample_harts[h];
+            if (hart.done) {
+                continue;
+            }
+            const char* why = NULL;
+            int ret = FM_OK;
+            if (std::find(good.begin(), good.end(), hart.pc & 0xffffffffffULL) != good.end()) {
+                why = "good trap";
+            } else if (std::find(bad.begin(), bad.end(), hart.pc & 0xffffffffffULL) != bad.end()) {
+                why = "bad trap";
+                status = SIM_FAIL;
+            } else if (hart.instret >= limit) {
+                why = "+sample_instrs";
+            } else if ((ret = hart.step()) == FM_ECALL) {
+                why = "ecall";
+            } else if (ret == FM_EBREAK) {
+                why = "ebreak";
+            } else if (ret == FM_ILLEGAL) {
+                why = "unsupported instruction";
+                status = SIM_FAIL;
+            }
+            if (why) {
+                std::cout << "hart " << h << " done after " << hart.instret << " instructions: "
+                          << why << " at pc 0x" << std::hex << hart.pc << std::dec << std::endl;
+                hart.done = true;
+            } else {
+                active = true;
+            }
+        }
+        if (!active) {
+            break;
+        }
+    }
+    return active;
+}
+
+// Ticks until every hart that is not done left the boot stub, which it
+// does once it commits an instruction outside of the stub after one in
+// it. false when that takes more than limit cycles.
+bool sample_boot(uint64_t limit) {
+    std::vector<int> state(sample_harts.size(), 0);
+    uint64_t end = main_time / 500 + limit;
+    while (!Verilated::gotFinish() && main_time / 500 < end) {
+        bool booted = true;
+        for (size_t h = 0; h < sample_harts.size(); h++) {
+            uint64_t pc = sample_pc(h);
+            bool in_stub = pc >= sample_stub && pc < sample_stub + sample_stub_size();
+            if (!state[h] && in_stub) {
+                state[h] = 1;
+            } else if (state[h] == 1 && !in_stub) {
+                state[h] = 2;
+            }
+            booted = booted && (sample_harts[h].done || state[h] == 2);
+        }
+        if (booted) {
+            return true;
+        }
+        tick();
+    }
+    return false;
+}
+
+// One detailed interval from the current functional state, returns the
+// measured cycles and the instructions the harts retired in them.
+void sample_interval(uint64_t boot, uint64_t warmup, uint64_t detail, uint64_t& cycles,
+                     uint64_t& instrs) {
+    main_time = 0;
+    sim_status = -1;
+    Verilated::gotFinish(false);
+    cycles = instrs = 0;
+#ifdef VERILATOR_SAVABLE
+    test_reused = reset_usable();
+#endif
+    if (test_reused) {
+#ifdef VERILATOR_SAVABLE
+        reset_from_snapshot();
+#endif
+    } else {
+        delete top;
+        top = new Vcmp_top;
+        clocks_init();
+        reset_and_init();
+    }
+    svSetScope(svGetScopeFromName("TOP.cmp_top"));
+    if (!sample_boot(boot)) {
+        std::cout << "Interval: the harts did not leave the boot stub in " << boot
+                  << " cycles" << std::endl;
+        return;
+    }
+    uint64_t start = main_time / 500 + warmup;
+    while (!Verilated::gotFinish() && main_time / 500 < start) {
+        tick();
+    }
+    uint64_t retired = 0;
+    for (size_t h = 0; h < sample_harts.size(); h++) {
+        retired -= sample_retired(h);
+    }
+    while (!Verilated::gotFinish() && main_time / 500 < start + detail) {
+        tick();
+    }
+    for (size_t h = 0; h < sample_harts.size(); h++) {
+        retired += sample_retired(h);
+    }
+    cycles = main_time / 500 > start ? main_time / 500 - start : 0;
+    instrs = cycles ? retired : 0;
+}
+
+// Two sided 95% quantile of Student's t for n - 1 degrees of freedom.
+double sample_t95(size_t n) {
+    static const double t[] = { 0, 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306,
+                                2.262, 2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110,
+                                2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056,
+                                2.052, 2.048, 2.045, 2.042 };
+    return n - 1 < sizeof(t) / sizeof(t[0]) ? t[n - 1] : 1.96;
+}
+
+int run_sampled() {
+    uint64_t period = plusarg_u64("sample_period", 0);
+    uint64_t warm_lines = plusarg_u64("sample_warm_lines", 256);
+    uint64_t boot = plusarg_u64("sample_boot", 200000);
+    uint64_t warmup = plusarg_u64("sample_warmup", 500);
+    uint64_t detail = plusarg_u64("sample_detail", 10000);
+    uint64_t max = plusarg_u64("sample_max", ~0ULL);
+    uint64_t limit = plusarg_u64("sample_instrs", ~0ULL);
+    uint64_t nharts = plusarg_u64("sample_harts", 1);
+    sample_entry = plusarg_u64("sample_entry", 0x80000000ULL);
+    sample_stub = plusarg_u64("sample_stub", 0);
+    const char* arg = Verilated::commandArgsPlusMatch("sample_results=");
+    std::string results = arg[0] ? arg + strlen("+sample_results=") : "my_top_sample.json";
+    std::string ckpt = "my_top_sample.iob";
+    std::vector<uint64_t> good, bad;
+    sample_traps("good_trap", good);
+    sample_traps("bad_trap", bad);
+
+    sample_harts.clear();
+    for (uint64_t h = 0; h < nharts; h++) {
+        sample_harts.push_back(func_hart(h, sample_entry));
+        sample_harts.back().warm(warm_lines);
+    }
+    if (!sample_stub) {
+        std::cout << "Error: +sample_period needs +sample_stub=ADDR, " << sample_stub_size()
+                  << " bytes outside of the workload memory" << std::endl;
+        return SIM_FAIL;
+    }
+    iob_model_init((char *) mem_file.c_str(), (char *) ev_file.c_str(), 0);
+    if (!sample_stub_free()) {
+        return SIM_FAIL;
+    }
+    std::cout << "Sampled simulation of " << nharts << " harts from 0x" << std::hex
+              << sample_entry << std::dec << ", " << warm_lines << " warm lines, " << warmup
+              << " + " << detail << " cycles every " << period << " instructions" << std::endl;
+#ifdef VERILATOR_SAVABLE
+    reset_snapshot = true;
+#endif
+    test_key.clear();
+    test_reused = false;
+
+    std::vector<uint64_t> at, cycles, instrs;
+    std::vector<double> cpis;
+    double functional_s = 0, detailed_s = 0;
+    int status = SIM_PASS;
+    while (true) {
+        struct timespec t0, t1, t2;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        bool active = sample_advance(period, limit, good, bad, status);
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        functional_s += (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) * 1e-9;
+        if (!active) {
+            break;
+        }
+        if (cpis.size() >= max) {
+            continue;
+        }
+
+        uint64_t retired = 0, running = 0, c, i;
+        for (size_t h = 0; h < sample_harts.size(); h++) {
+            retired += sample_harts[h].instret;
+            running += !sample_harts[h].done;
+        }
+        if (iob_model_save(ckpt.c_str())) {
+            return SIM_FAIL;
+        }
+        // the interval model starts its own memory from the checkpoint
+        iob_model_done();
+        sample_ckpt = ckpt;
+        sample_interval(boot, warmup, detail, c, i);
+        iob_model_done();
+        iob_model_init((char *) mem_file.c_str(), (char *) ev_file.c_str(), 1);
+        if (iob_model_restore(ckpt.c_str())) {
+            return SIM_FAIL;
+        }
+        sample_ckpt.clear();
+        clock_gettime(CLOCK_MONOTONIC, &t2);
+        detailed_s += (t2.tv_sec - t1.tv_sec) + (t2.tv_nsec - t1.tv_nsec) * 1e-9;
+
+        // cycles per instruction of one hart, the harts run in parallel
+        std::cout << "Sample " << cpis.size() << " at " << retired << " instructions: ";
+        if (!i) {
+            std::cout << "nothing retired in " << c << " cycles, dropped" << std::endl;
+            continue;
+        }
+        at.push_back(retired);
+        cycles.push_back(c);
+        instrs.push_back(i);
+        cpis.push_back((double) c * running / i);
+        std::cout << i << " instructions in " << c << " cycles, CPI " << cpis.back() << std::endl;
+    }
+    iob_model_done();
+    remove(ckpt.c_str());
+#ifdef VERILATOR_SAVABLE
+    reset_remove();
+    reset_snapshot = false;
+#endif
+    delete top;
+    top = NULL;
+
+    uint64_t total = 0;
+    for (size_t h = 0; h < sample_harts.size(); h++) {
+        total = std::max(total, sample_harts[h].instret);
+    }
+    size_t n = cpis.size();
+    double mean = 0, var = 0, half = 0;
+    for (size_t k = 0; k < n; k++) {
+        mean += cpis[k] / n;
+    }
+    for (size_t k = 0; n > 1 && k < n; k++) {
+        var += (cpis[k] - mean) * (cpis[k] - mean) / (n - 1);
+    }
+    if (n > 1) {
+        half = sample_t95(n) * sqrt(var / n);
+    }
+    if (!n) {
+        std::cout << "Error: no interval was measured" << std::endl;
+        status = SIM_FAIL;
+    } else {
+        std::cout << "Sampled CPI " << mean << " +- " << half << " (95%, " << n
+                  << " samples), estimated " << (uint64_t) (mean * total + 0.5) << " cycles for "
+                  << total << " instructions" << std::endl;
+    }
+
+    FILE* fp = fopen(results.c_str(), "w");
+    if (!fp) {
+        std::cout << "Error: can not write " << results << std::endl;
+        return SIM_FAIL;
+    }
+    fprintf(fp, "{\"result\":\"%s\",\"harts\":%llu,\"instructions\":%llu,\"samples\":%zu,"
+            "\"cpi\":%.4f,\"cpi_stddev\":%.4f,\"cpi_ci95\":[%.4f,%.4f],"
+            "\"cycles_est\":%.0f,\"cycles_ci95\":[%.0f,%.0f],"
+            "\"functional_s\":%.3f,\"detailed_s\":%.3f,\"intervals\":[",
+            sim_status_name(status), (unsigned long long) nharts, (unsigned long long) total, n,
+            mean, sqrt(var), mean - half, mean + half, mean * total, (mean - half) * total,
+            (mean + half) * total, functional_s, detailed_s);
+    for (size_t k = 0; k < n; k++) {
+        fprintf(fp, "%s{\"at\":%llu,\"cycles\":%llu,\"instrs\":%llu,\"cpi\":%.4f}",
+                k ? "," : "", (unsigned long long) at[k], (unsigned long long) cycles[k],
+                (unsigned long long) instrs[k], cpis[k]);
+    }
+    fprintf(fp, "]}\n");
+    fclose(fp);
+    return status;
+}
+#endif
+
+// The value of +name on the command line of the process, def without it.
+std::string main_plusarg(const char* name, const char* def) {
+    size_t len = strlen(name);
+    for (size_t i = 1; i < main_args.size(); i++) {
+        if (main_args[i][0] == '+' && !main_args[i].compare(1, len, name)) {
+            return main_args[i].substr(1 + len);
+        }
+    }
+    return def;
+}
+
+// The plusargs of batch test num, the rest of its line and the names of
+// its statistics files, which the line may give itself. The rest of the
+// line becomes the test_key.
+std::string batch_args(std::istream& words, int num) {
+    std::ostringstream args;
+    std::string word;
+    while (words >> word) {
+        args << word << " ";
+    }
+    test_key = args.str();
+    if (main_plusarg("sram_init_cycles=", "").empty()) {
+        args << "+sram_backdoor_init ";
+    }
+    std::string stats = main_plusarg("stats_file=", "my_top_stats.json");
+    size_t dot = stats.rfind('.');
+    if (dot == std::string::npos || stats.find('/', dot) != std::string::npos) {
+        dot = stats.size();
+    }
+    args << "+stats_file=" << stats.substr(0, dot) << "_" << num << stats.substr(dot) << " ";
+    args << "+iob_stats_file=" << main_plusarg("iob_stats_file=", "iob_stats") << "_" << num;
+    return args.str();
+}
+
+int run_batch(const char* list) {
+    std::ifstream in(list);
+    if (!in) {
+        std::cout << "Error: can not open batch file " << list << std::endl;
+        return SIM_FAIL;
+    }
+    const char* arg = Verilated::commandArgsPlusMatch("batch_results=");
+    std::string results = arg[0] ? arg + strlen("+batch_results=") : "my_top_batch.jsonl";
+    FILE* fp = fopen(results.c_str(), "w");
+    if (!fp) {
+        std::cout << "Error: can not write " << results << std::endl;
+        return SIM_FAIL;
+    }
+#ifdef VERILATOR_SAVABLE
+    reset_snapshot = true;
+#endif
+
+    std::string line;
+    int num = 0, failed = 0;
+    while (std::getline(in, line)) {
+        std::istringstream words(line);
+        if (!(words >> mem_file) || mem_file[0] == '#') {
+            continue;
+        }
+        if (!(words >> ev_file)) {
+            std::cout << "Error: no diag.ev for " << mem_file << " in " << list << std::endl;
+            failed++;
+            continue;
+        }
+        std::istringstream args(batch_args(words, num));
+        set_test_args(args);
+
+        std::cout << "Batch test " << num << ": " << mem_file << " " << ev_file << std::endl;
+        struct timespec t0, t1;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        int status = run_test();
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        fprintf(fp, "{\"test\":%d,\"mem_image\":\"%s\",\"diag_ev\":\"%s\","
+                "\"result\":\"%s\",\"exit_code\":%d,\"cycles\":%llu,\"wall_s\":%.3f,"
+                "\"model\":\"%s\",\"setup_s\":%.3f}\n",
+                num, mem_file.c_str(), ev_file.c_str(), sim_status_name(status), status,
+                (unsigned long long)(main_time / 500),
+                (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) * 1e-9,
+                test_reused ? "reset_snapshot" : "new", test_setup_s);
+        fflush(fp);
+        if (status != SIM_PASS) {
+            failed++;
+        }
+        num++;
+    }
+    fclose(fp);
+#ifdef VERILATOR_SAVABLE
+    reset_remove();
+    delete top;
+    top = NULL;
+    reset_snapshot = false;
+#endif
+    std::cout << "Batch: " << num - failed << " of " << num << " tests passed, results in "
+              << results << std::endl;
+    return failed ? SIM_FAIL : SIM_PASS;
+}
+
+int main(int argc, char **argv, char **env) {
+std::cout << "Started" << std::endl << std::flush;
+Verilated::commandArgs(argc, argv);
+main_args.assign(argv, argv + argc);
+live_stats_memory(&iob_mem_reads, &iob_mem_writes);
+#if defined(VL_THREADED) && defined(VLT_THREADS)
+// The worker threads of the model spin while waiting for work, running
+// with more threads than cores makes the simulation slower, not faster.
+unsigned int cores = std::thread::hardware_concurrency();
+std::cout << "Threaded model, " << VLT_THREADS << " threads" << std::endl;
+if (cores && cores < VLT_THREADS) {
+    std::cout << "Warning: only " << cores << " cores available for "
+              << VLT_THREADS << " model threads" << std::endl;
+}
+#endif
+#ifdef VERILATOR_TRACE
+Verilated::traceEverOn(true);
+#endif
+
+const char* batch_arg = Verilated::commandArgsPlusMatch("batch_file=");
+if (batch_arg[0]) {
+    std::string list = batch_arg + strlen("+batch_file=");
+    exit(run_batch(list.c_str()));
+}
+#ifdef SAMPLED_SIM
+if (Verilated::commandArgsPlusMatch("sample_period=")[0]) {
+    exit(run_sampled());
+}
+#endif
+exit(run_test());
 }
@@ -0,0 +1,221 @@
+/*
+Copyright (c) 2019 Princeton University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Princeton University nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY PRINCETON UNIVERSITY "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL PRINCETON UNIVERSITY BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "sim_stats.h"
+#include "live_stats.h"
+#include "verilated.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+namespace {
+
+struct stats_time {
+    double wall;
+    double cpu;
+};
+
+struct stats_phase {
+    std::string name;
+    uint64_t cycles;
+    stats_time time;
+};
+
+struct perf_counter {
+    const char* name;
+    uint32_t type;
+    uint64_t config;
+    int fd;
+};
+
+perf_counter perf[] = {
+    { "cpu_cycles",   PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES,   -1 },
+    { "instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, -1 },
+    { "cache_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, -1 },
+};
+const int perf_num = sizeof(perf) / sizeof(perf[0]);
+
+bool stats_on = false;
+bool at_exit_set = false;
+std::string stats_file = "my_top_stats.json";
+std::vector<stats_phase> phases;
+stats_time start, phase_start, speed_start;
+uint64_t phase_cycle = 0;
+uint64_t last_cycle = 0;
+uint64_t speed_period = 0;
+uint64_t speed_cycle = 0;
+
+stats_time now() {
+    struct timespec ts;
+    stats_time t;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    t.wall = ts.tv_sec + ts.tv_nsec * 1e-9;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    t.cpu = ts.tv_sec + ts.tv_nsec * 1e-9;
+    return t;
+}
+
+// Counts user space of this process and of threads created later, so
+// the worker threads of a --threads model are included.
+void perf_open() {
+    for (int i = 0; i < perf_num; i++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = perf[i].type;
+        attr.config = perf[i].config;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.inherit = 1;
+        perf[i].fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+        if (perf[i].fd < 0) {
+            std::cout << "Warning: perf counter " << perf[i].name
+                      << " not available" << std::endl;
+        }
+    }
+}
+
+void at_exit() {
+    sim_stats_finish(last_cycle);
+}
+
+}  // namespace
+
+void sim_stats_init() {
+    // a batch run passes a name per test
+    const char* arg = Verilated::commandArgsPlusMatch("stats_file=");
+    stats_file = arg[0] ? arg + strlen("+stats_file=") : "my_top_stats.json";
+    arg = Verilated::commandArgsPlusMatch("speed_period=");
+    if (arg[0]) {
+        speed_period = strtoull(arg + strlen("+speed_period="), NULL, 0);
+        speed_cycle = speed_period;
+    }
+    if (Verilated::commandArgsPlusMatch("perf_counters")[0]) {
+        perf_open();
+    }
+    // batch runs call this again for every test
+    phases.clear();
+    phase_cycle = last_cycle = 0;
+    start = phase_start = speed_start = now();
+    stats_on = true;
+    live_stats_init();
+    if (!at_exit_set) {
+        atexit(at_exit);
+        at_exit_set = true;
+    }
+}
+
+void sim_stats_phase(const char* name, uint64_t cycle) {
+    stats_time t = now();
+    if (!phases.empty()) {
+        stats_phase& last = phases.back();
+        last.cycles = cycle - phase_cycle;
+        last.time.wall = t.wall - phase_start.wall;
+        last.time.cpu = t.cpu - phase_start.cpu;
+    }
+    if (name) {
+        stats_phase next;
+        next.name = name;
+        next.cycles = 0;
+        next.time.wall = next.time.cpu = 0;
+        phases.push_back(next);
+    }
+    phase_start = t;
+    phase_cycle = cycle;
+    last_cycle = cycle;
+    if (name) {
+        live_stats_phase(name, cycle);
+    }
+}
+
+void sim_stats_cycle(uint64_t cycle) {
+    last_cycle = cycle;
+    live_stats_cycle(cycle);
+    if (!speed_period || cycle < speed_cycle) {
+        return;
+    }
+    stats_time t = now();
+    double wall = t.wall - speed_start.wall;
+    std::cout << "Info: cycle " << cycle << ", "
+              << (wall > 0 ? speed_period / wall : 0) << " cycles/s" << std::endl;
+    speed_start = t;
+    speed_cycle = cycle + speed_period;
+}
+
+void sim_stats_finish(uint64_t cycle) {
+    if (!stats_on) {
+        return;
+    }
+    stats_on = false;
+    sim_stats_phase(NULL, cycle);
+
+    stats_time t = now();
+    double wall = t.wall - start.wall;
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    FILE* fp = fopen(stats_file.c_str(), "w");
+    if (!fp) {
+        std::cout << "Warning: can not write " << stats_file << std::endl;
+        return;
+    }
+    fprintf(fp, "{\"phases\":[");
+    for (size_t i = 0; i < phases.size(); i++) {
+        fprintf(fp, "%s{\"name\":\"%s\",\"cycles\":%llu,\"wall_s\":%.6f,\"cpu_s\":%.6f}",
+                i ? "," : "", phases[i].name.c_str(),
+                (unsigned long long)phases[i].cycles,
+                phases[i].time.wall, phases[i].time.cpu);
+    }
+    fprintf(fp, "],\"cycles\":%llu,\"wall_s\":%.6f,\"cpu_s\":%.6f,"
+            "\"cycles_per_s\":%.1f,\"peak_rss_kb\":%ld",
+            (unsigned long long)cycle, wall, t.cpu - start.cpu,
+            wall > 0 ? cycle / wall : 0, usage.ru_maxrss);
+    for (int i = 0; i < perf_num; i++) {
+        uint64_t count;
+        if (perf[i].fd < 0) {
+            continue;
+        }
+        if (read(perf[i].fd, &count, sizeof(count)) == sizeof(count)) {
+            fprintf(fp, ",\"%s\":%llu", perf[i].name, (unsigned long long)count);
+        }
+        close(perf[i].fd);
+        perf[i].fd = -1;
+    }
+    fprintf(fp, "}\n");
+    fclose(fp);
+
+    std::cout << "Simulated " << cycle << " cycles in " << wall << " s, "
+              << (wall > 0 ? cycle / wall : 0) << " cycles/s" << std::endl;
+}
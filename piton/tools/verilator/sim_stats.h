@@ -0,0 +1,54 @@
+/*
+Copyright (c) 2019 Princeton University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Princeton University nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY PRINCETON UNIVERSITY "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL PRINCETON UNIVERSITY BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Wall/CPU time of the harness phases, simulation speed and peak memory
+// of a Verilator run, written as JSON when the process exits.
+//
+// Run time plusargs
+//   +stats_file=NAME     summary file (default my_top_stats.json), the
+//                        batch mode of my_top.cpp adds _<test> to it
+//   +speed_period=N      print the cycles per second every N cycles
+//   +perf_counters       add cpu cycles, instructions and cache misses
+//                        from perf_event_open(2) to the summary
+// The phases and the speed are also published while the simulation runs,
+// see live_stats.h.
+
+#ifndef SIM_STATS_H
+#define SIM_STATS_H
+
+#include <stdint.h>
+
+// start a new summary, may be called again once sim_stats_finish() ran
+void sim_stats_init();
+// end the current phase at cycle and start the one called name
+void sim_stats_phase(const char* name, uint64_t cycle);
+// called every cycle, prints the speed every +speed_period cycles
+void sim_stats_cycle(uint64_t cycle);
+// end the last phase and write the summary, also done at exit
+void sim_stats_finish(uint64_t cycle);
+
+#endif
@@ -0,0 +1,106 @@
+/*
+Copyright (c) 2019 Princeton University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Princeton University nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY PRINCETON UNIVERSITY "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL PRINCETON UNIVERSITY BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "vlt_harness.h"
+#include <fstream>
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+uint64_t vlt_time = 0;
+
+// called by $time in verilog
+double sc_time_stamp() {
+    return vlt_time;
+}
+
+uint64_t vlt_plusarg_u64(const char* name, uint64_t def) {
+    std::string match = std::string(name) + "=";
+    const char* arg = Verilated::commandArgsPlusMatch(match.c_str());
+    if (!arg[0]) {
+        return def;
+    }
+    return strtoull(arg + match.size() + 1, NULL, 0);
+}
+
+std::string vlt_plusarg_str(const char* name, const char* def) {
+    std::string match = std::string(name) + "=";
+    const char* arg = Verilated::commandArgsPlusMatch(match.c_str());
+    return arg[0] ? arg + match.size() + 1 : def;
+}
+
+const char* vlt_status_name(int status) {
+    static const char* names[] = { "PASS", "FAIL", "TIMEOUT" };
+    return status >= SIM_PASS && status <= SIM_TIMEOUT ? names[status] : "FAIL";
+}
+
+// counts the words like $readmemh, @addr moves to addr, // and /* */ are
+// comments
+uint64_t vlt_readmemh_entries(const char* file) {
+    std::ifstream in(file);
+    if (!in) {
+        return 0;
+    }
+    uint64_t addr = 0, entries = 0;
+    bool block = false;
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t pos = 0;
+        while (pos < line.size()) {
+            if (block) {
+                size_t end = line.find("*/", pos);
+                if (end == std::string::npos) {
+                    break;
+                }
+                block = false;
+                pos = end + 2;
+                continue;
+            }
+            if (isspace((unsigned char) line[pos])) {
+                pos++;
+            } else if (!line.compare(pos, 2, "//")) {
+                break;
+            } else if (!line.compare(pos, 2, "/*")) {
+                block = true;
+                pos += 2;
+            } else {
+                size_t end = pos;
+                while (end < line.size() && !isspace((unsigned char) line[end]) &&
+                       line.compare(end, 2, "//") && line.compare(end, 2, "/*")) {
+                    end++;
+                }
+                if (line[pos] == '@') {
+                    addr = strtoull(line.substr(pos + 1, end - pos - 1).c_str(), NULL, 16);
+                } else if (++addr > entries) {
+                    entries = addr;
+                }
+                pos = end;
+            }
+        }
+    }
+    return entries;
+}
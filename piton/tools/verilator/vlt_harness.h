@@ -0,0 +1,280 @@
+/*
+Copyright (c) 2019 Princeton University
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Princeton University nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY PRINCETON UNIVERSITY "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL PRINCETON UNIVERSITY BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Verilator harness library for the unit level environments.
+//
+// The manycore environment has its own harness (my_top.cpp). Every other
+// environment that builds with sims -vlt_build has a small adapter,
+// tools/verilator/env_<name>.cpp, picked by -vlt_harness= in its config
+// together with the verilated top module, -vlt_top=. The adapter creates
+// a vlt_harness<V<top>>, declares the clocks of the top ports, runs its
+// reset script, drives and checks the ports, and returns finish() from
+// main. The harness does the rest:
+//   clocks       any number of clocks with their own period and phase,
+//                the rising edges of the first one are the cycles. The
+//                edges are scheduled by clock_sched.h, clocks can be
+//                gated off.
+//   reset        a script of port values, each held for some cycles
+//   tracing      +notrace, +trace_start=N, +trace_stop=N, +trace_depth=N
+//                and +trace_file=NAME as in my_top.cpp, default file
+//                <name>.vcd or <name>.fst
+//   timeout      +max_cycles=N stops with SIM_TIMEOUT at cycle N
+//   exit codes   SIM_PASS, SIM_FAIL or SIM_TIMEOUT. A $finish before the
+//                adapter reports a result is SIM_FAIL.
+//   statistics   sim_stats.h and the live statistics of live_stats.h
+// Time is in ps, sc_time_stamp() returns it for $time.
+
+#ifndef VLT_HARNESS_H
+#define VLT_HARNESS_H
+
+#include "verilated.h"
+#include "sim_stats.h"
+#include "clock_sched.h"
+#include <iostream>
+#include <string>
+#include <stdint.h>
+#if defined(VERILATOR_FST)
+#include "verilated_fst_c.h"
+#define VERILATOR_TRACE
+typedef VerilatedFstC VerilatedTraceC;
+#define TRACE_EXT ".fst"
+#elif defined(VERILATOR_VCD)
+#include "verilated_vcd_c.h"
+#define VERILATOR_TRACE
+typedef VerilatedVcdC VerilatedTraceC;
+#define TRACE_EXT ".vcd"
+#endif
+
+// exit codes, the same as the ones of my_top.cpp
+#define SIM_PASS     0
+#define SIM_FAIL     1
+#define SIM_TIMEOUT  2
+
+// current simulation time in ps
+extern uint64_t vlt_time;
+
+uint64_t vlt_plusarg_u64(const char* name, uint64_t def);
+std::string vlt_plusarg_str(const char* name, const char* def);
+const char* vlt_status_name(int status);
+// number of entries $readmemh loads from file, 0 when it can not be read.
+// Verilator is two state, the test_source/test_sink of test_infrstrct can
+// not see the end of their vectors as x and get it from the adapter.
+uint64_t vlt_readmemh_entries(const char* file);
+
+// one step of a reset script, sig is set to value, then held for cycles
+// cycles of the main clock
+struct vlt_reset_step {
+    CData* sig;
+    CData value;
+    uint64_t cycles;
+};
+
+template <class Model>
+class vlt_harness {
+public:
+    Model* top;
+
+    vlt_harness(const char* name, int argc, char** argv) : name(name), status(-1) {
+        Verilated::commandArgs(argc, argv);
+#ifdef VERILATOR_TRACE
+        Verilated::traceEverOn(true);
+#endif
+        vlt_time = 0;
+        clocks.clear();
+        main_cycles = 0;
+        max_cycles = vlt_plusarg_u64("max_cycles", 0);
+        top = new Model;
+        sim_stats_init();
+        sim_stats_phase("construct", 0);
+#ifdef VERILATOR_TRACE
+        trace_init();
+#endif
+    }
+
+    ~vlt_harness() {
+#ifdef VERILATOR_TRACE
+        delete tfp;
+#endif
+        delete top;
+    }
+
+    // period and phase (time of the first edge, a rising one) in ps. The
+    // clock starts low. Returns the clock number for gate_clock().
+    int add_clock(CData* sig, uint64_t period, uint64_t phase = 0, const char* name = "clk") {
+        return clocks.add(name, sig, period, phase);
+    }
+
+    // stop or restart a clock, not the first one
+    void gate_clock(int clock, bool off) {
+        clocks.gate(clock, off);
+    }
+
+    // rising edges of the main clock so far
+    uint64_t cycle() const {
+        return main_cycles;
+    }
+
+    // false once the model called $finish, a result is known or the run
+    // timed out
+    bool running() {
+        if (status < 0 && max_cycles && main_cycles >= max_cycles) {
+            std::cout << main_cycles << " : Simulation -> TIMEOUT (max_cycles = "
+                      << max_cycles << ")" << std::endl;
+            status = SIM_TIMEOUT;
+        }
+        return status < 0 && !Verilated::gotFinish();
+    }
+
+    // advance to the next edge of any clock, clocks with an edge at the
+    // same time toggle together
+    void step() {
+        vlt_time = clocks.step();
+        if (clocks.rose(0)) {
+            main_cycles++;
+#ifdef VERILATOR_TRACE
+            trace_window();
+#endif
+            sim_stats_cycle(main_cycles);
+        }
+        top->eval();
+#ifdef VERILATOR_TRACE
+        if (tfp && tfp->isOpen()) {
+            tfp->dump(vlt_time);
+        }
+#endif
+    }
+
+    // inputs changed between edges, they are traced with the next edge
+    void eval() {
+        top->eval();
+    }
+
+    // run to the next rising or falling edge of the main clock
+    void posedge() {
+        do {
+            step();
+        } while (!clocks.rose(0));
+    }
+
+    void negedge() {
+        do {
+            step();
+        } while (!clocks.fell(0));
+    }
+
+    // n cycles of the main clock, less when the run stops
+    void cycles(uint64_t n) {
+        for (uint64_t end = main_cycles + n; main_cycles < end && running(); ) {
+            posedge();
+        }
+    }
+
+    // the ports of the script are set in order, the clocks run meanwhile
+    void reset(const vlt_reset_step* script, int steps) {
+        sim_stats_phase("reset", main_cycles);
+        for (int i = 0; i < steps && running(); i++) {
+            *script[i].sig = script[i].value;
+            eval();
+            cycles(script[i].cycles);
+        }
+        sim_stats_phase("test", main_cycles);
+    }
+
+    // verdict of the adapter, the first one counts
+    void result(int status) {
+        if (this->status < 0) {
+            this->status = status;
+        }
+    }
+
+    // print the verdict, close the trace and return the exit code
+    int finish() {
+        if (status < 0) {
+            status = SIM_FAIL;
+        }
+        top->final();
+        sim_stats_finish(main_cycles);
+#ifdef VERILATOR_TRACE
+        if (tfp && tfp->isOpen()) {
+            tfp->close();
+        }
+#endif
+        if (status == SIM_PASS) {
+            std::cout << main_cycles << " : Simulation -> PASS (HIT GOOD TRAP)" << std::endl;
+        } else if (status == SIM_FAIL) {
+            std::cout << main_cycles << " : Simulation -> FAIL (HIT BAD TRAP)" << std::endl;
+        }
+        std::cout << name << ": " << vlt_status_name(status) << " after "
+                  << main_cycles << " cycles" << std::endl;
+        if (clocks.domains().size() > 1) {
+            clocks.report(std::cout);
+        }
+        return status;
+    }
+
+private:
+    std::string name;
+    clock_sched clocks;
+    uint64_t main_cycles;
+    uint64_t max_cycles;
+    int status;
+#ifdef VERILATOR_TRACE
+    VerilatedTraceC* tfp;
+    uint64_t trace_start;
+    uint64_t trace_stop;
+    std::string trace_file;
+
+    void trace_init() {
+        tfp = NULL;
+        if (Verilated::commandArgsPlusMatch("notrace")[0]) {
+            return;
+        }
+        trace_start = vlt_plusarg_u64("trace_start", 0);
+        trace_stop = vlt_plusarg_u64("trace_stop", ~0ULL);
+        trace_file = vlt_plusarg_str("trace_file", (name + TRACE_EXT).c_str());
+        tfp = new VerilatedTraceC;
+        top->trace(tfp, vlt_plusarg_u64("trace_depth", 99));
+        std::cout << "Tracing cycles " << trace_start << " to " << trace_stop
+                  << " into " << trace_file << std::endl;
+    }
+
+    void trace_window() {
+        if (!tfp) {
+            return;
+        }
+        if (!tfp->isOpen() && main_cycles >= trace_start && main_cycles < trace_stop) {
+            tfp->open(trace_file.c_str());
+        } else if (tfp->isOpen() && main_cycles >= trace_stop) {
+            tfp->close();
+            delete tfp;
+            tfp = NULL;
+        }
+    }
+#endif
+};
+
+#endif
@@ -0,0 +1,101 @@
+#!/bin/bash
+# Copyright (c) 2019 Princeton University
+# All rights reserved.
+# 
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#     * Redistributions of source code must retain the above copyright
+#       notice, this list of conditions and the following disclaimer.
+#     * Redistributions in binary form must reproduce the above copyright
+#       notice, this list of conditions and the following disclaimer in the
+#       documentation and/or other materials provided with the distribution.
+#     * Neither the name of Princeton University nor the
+#       names of its contributors may be used to endorse or promote products
+#       derived from this software without specific prior written permission.
+# 
+# THIS SOFTWARE IS PROVIDED BY PRINCETON UNIVERSITY "AS IS" AND
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL PRINCETON UNIVERSITY BE LIABLE FOR ANY
+# DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# Tile and thread-count sweep of a multi-threaded verilator model (sims
+# -vlt_threads). For every tile grid XxY and thread count N the model is
+# built as build_id thread_sweep_XxY_tN and DIAG is run on it in
+# sweep_XxY_tN/, its run statistics (+stats_file, see sim_stats.h) become
+# one json line of the sweep log, like the build times of -vlt_build_times:
+#   {"config": "manycore_2x2_t4", "date": ..., "host": ..., "cores": 16,
+#    "x_tiles": 2, "y_tiles": 2, "tiles": 4, "threads": 4,
+#    "diag": "princeton-test-test.s", "cycles": ..., "wall_s": ...,
+#    "cpu_s": ..., "cycles_per_s": ..., "speedup": ...}
+# speedup is the cycles per second over the ones of the first thread count
+# of the same grid.
+#   vlt_thread_sweep.sh [-g "1x1 2x2 4x4"] [-t "1 2 4 8 16"] [-o FILE] DIAG [sims options]
+# The grids default to 1, 4 and 16 tiles, the counts to 1 to 16 threads.
+# The sims options (-sys=..., ...) go to every build and run, the tiles
+# are set by the script. FILE defaults to vlt_thread_sweep.jsonl.
+
+GRIDS="1x1 2x2 4x4"
+THREADS="1 2 4 8 16"
+LOG=vlt_thread_sweep.jsonl
+USAGE="usage: vlt_thread_sweep.sh [-g GRIDS] [-t THREADS] [-o FILE] DIAG [sims options]"
+while getopts "g:t:o:" opt; do
+    case $opt in
+        g) GRIDS=$OPTARG ;;
+        t) THREADS=$OPTARG ;;
+        o) LOG=$OPTARG ;;
+        *) echo "$USAGE"; exit 2 ;;
+    esac
+done
+shift $((OPTIND - 1))
+if [ $# -lt 1 ]; then
+    echo "$USAGE"
+    exit 2
+fi
+DIAG=$1
+shift
+case $LOG in
+    /*) ;;
+    *) LOG=$PWD/$LOG ;;
+esac
+
+HOST=$(hostname)
+CORES=$(getconf _NPROCESSORS_ONLN 2> /dev/null || echo 0)
+SYS=$(echo "$@" | sed -n 's/.*-sys=\([^ ]*\).*/\1/p')
+
+# value of a number field of the run statistics
+stats_field() {
+    sed -n "s/.*\"$1\":\([0-9.]*\).*/\1/p" $2
+}
+
+for grid in $GRIDS; do
+    x=${grid%x*}
+    y=${grid#*x}
+    base=""
+    for n in $THREADS; do
+        name=${grid}_t$n
+        sims -vlt_build -vlt_threads=$n -x_tiles=$x -y_tiles=$y -build_id=thread_sweep_$name "$@" || {
+            echo "vlt_thread_sweep: building the $name model failed"; exit 1; }
+        run=$PWD/sweep_$name
+        mkdir -p $run
+        ( cd $run && sims -vlt_run -vlt_threads=$n -x_tiles=$x -y_tiles=$y \
+              -build_id=thread_sweep_$name "$@" $DIAG \
+              -sim_run_args=+stats_file=$run/sweep_stats.json ) || {
+            echo "vlt_thread_sweep: the $name run failed, see $run"; exit 1; }
+        if [ ! -f $run/sweep_stats.json ]; then
+            echo "vlt_thread_sweep: no run statistics in $run"; exit 1
+        fi
+        speed=$(stats_field cycles_per_s $run/sweep_stats.json)
+        base=${base:-$speed}
+        printf '{"config": "%s_%s", "date": "%s", "host": "%s", "cores": %d, "x_tiles": %d, "y_tiles": %d, "tiles": %d, "threads": %d, "diag": "%s", "cycles": %d, "wall_s": %.2f, "cpu_s": %.2f, "cycles_per_s": %.1f, "speedup": %.2f}\n' \
+            "${SYS:-manycore}" $name "$(date +%Y-%m-%dT%H:%M:%S)" "$HOST" $CORES $x $y $((x * y)) $n \
+            "$(basename $DIAG)" $(stats_field cycles $run/sweep_stats.json) \
+            $(stats_field wall_s $run/sweep_stats.json) $(stats_field cpu_s $run/sweep_stats.json) \
+            $speed $(awk -v s=$speed -v b=$base 'BEGIN { print (b > 0) ? s / b : 0 }') | tee -a $LOG
+    done
+done
@@ -23,6 +23,9 @@
 // (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+// predates func_en/stall_en of dmbr and does not elaborate, verilator
+// builds use tools/verilator/env_dmbr.cpp instead
+`ifndef VERILATOR
 `timescale 1ns/100ps
 `include "dmbr_define.v"
 module testbench();
@@ -284,6 +287,8 @@ end
 
 endmodule
 
+`endif // VERILATOR
+
 
 
   
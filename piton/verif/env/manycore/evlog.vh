@@ -0,0 +1,83 @@
+// Copyright (c) 2019 Princeton University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Princeton University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY PRINCETON UNIVERSITY "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL PRINCETON UNIVERSITY BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// DPI-C imports of the monitor event log (tools/pli/evlog/evlog_dpi.cc).
+// tools/bin/evlog_rewrite.py includes this in every monitor module it
+// rewrites for sims -evlog, evlog_<n> logs a call site with n arguments,
+// each passed with its width ($bits).
+
+`ifndef EVLOG_VH
+`define EVLOG_VH
+
+`define EVLOG_MAX_WIDTH 512
+
+`endif
+
+import "DPI-C" function int evlog_source(input int id, input string name);
+import "DPI-C" function void evlog_0(input int site, input string format, input longint unsigned t);
+import "DPI-C" function void evlog_1(input int site, input string format, input longint unsigned t,
+                                     input int w0, input logic [`EVLOG_MAX_WIDTH-1:0] a0);
+import "DPI-C" function void evlog_2(input int site, input string format, input longint unsigned t,
+                                     input int w0, input logic [`EVLOG_MAX_WIDTH-1:0] a0,
+                                     input int w1, input logic [`EVLOG_MAX_WIDTH-1:0] a1);
+import "DPI-C" function void evlog_3(input int site, input string format, input longint unsigned t,
+                                     input int w0, input logic [`EVLOG_MAX_WIDTH-1:0] a0,
+                                     input int w1, input logic [`EVLOG_MAX_WIDTH-1:0] a1,
+                                     input int w2, input logic [`EVLOG_MAX_WIDTH-1:0] a2);
+import "DPI-C" function void evlog_4(input int site, input string format, input longint unsigned t,
+                                     input int w0, input logic [`EVLOG_MAX_WIDTH-1:0] a0,
+                                     input int w1, input logic [`EVLOG_MAX_WIDTH-1:0] a1,
+                                     input int w2, input logic [`EVLOG_MAX_WIDTH-1:0] a2,
+                                     input int w3, input logic [`EVLOG_MAX_WIDTH-1:0] a3);
+import "DPI-C" function void evlog_5(input int site, input string format, input longint unsigned t,
+                                     input int w0, input logic [`EVLOG_MAX_WIDTH-1:0] a0,
+                                     input int w1, input logic [`EVLOG_MAX_WIDTH-1:0] a1,
+                                     input int w2, input logic [`EVLOG_MAX_WIDTH-1:0] a2,
+                                     input int w3, input logic [`EVLOG_MAX_WIDTH-1:0] a3,
+                                     input int w4, input logic [`EVLOG_MAX_WIDTH-1:0] a4);
+import "DPI-C" function void evlog_6(input int site, input string format, input longint unsigned t,
+                                     input int w0, input logic [`EVLOG_MAX_WIDTH-1:0] a0,
+                                     input int w1, input logic [`EVLOG_MAX_WIDTH-1:0] a1,
+                                     input int w2, input logic [`EVLOG_MAX_WIDTH-1:0] a2,
+                                     input int w3, input logic [`EVLOG_MAX_WIDTH-1:0] a3,
+                                     input int w4, input logic [`EVLOG_MAX_WIDTH-1:0] a4,
+                                     input int w5, input logic [`EVLOG_MAX_WIDTH-1:0] a5);
+import "DPI-C" function void evlog_7(input int site, input string format, input longint unsigned t,
+                                     input int w0, input logic [`EVLOG_MAX_WIDTH-1:0] a0,
+                                     input int w1, input logic [`EVLOG_MAX_WIDTH-1:0] a1,
+                                     input int w2, input logic [`EVLOG_MAX_WIDTH-1:0] a2,
+                                     input int w3, input logic [`EVLOG_MAX_WIDTH-1:0] a3,
+                                     input int w4, input logic [`EVLOG_MAX_WIDTH-1:0] a4,
+                                     input int w5, input logic [`EVLOG_MAX_WIDTH-1:0] a5,
+                                     input int w6, input logic [`EVLOG_MAX_WIDTH-1:0] a6);
+import "DPI-C" function void evlog_8(input int site, input string format, input longint unsigned t,
+                                     input int w0, input logic [`EVLOG_MAX_WIDTH-1:0] a0,
+                                     input int w1, input logic [`EVLOG_MAX_WIDTH-1:0] a1,
+                                     input int w2, input logic [`EVLOG_MAX_WIDTH-1:0] a2,
+                                     input int w3, input logic [`EVLOG_MAX_WIDTH-1:0] a3,
+                                     input int w4, input logic [`EVLOG_MAX_WIDTH-1:0] a4,
+                                     input int w5, input logic [`EVLOG_MAX_WIDTH-1:0] a5,
+                                     input int w6, input logic [`EVLOG_MAX_WIDTH-1:0] a6,
+                                     input int w7, input logic [`EVLOG_MAX_WIDTH-1:0] a7);
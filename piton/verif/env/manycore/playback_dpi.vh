@@ -0,0 +1,49 @@
+// Copyright (c) 2019 Princeton University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of Princeton University nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY PRINCETON UNIVERSITY "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL PRINCETON UNIVERSITY BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// DPI-C imports of the binary playback stimulus library
+// (tools/pli/playback/playback_dpi.cc), used by the playback dump and
+// driver modules when PLAYBACK_DPI is defined (sims -playback_dpi). The
+// vectors are passed at `PLAYBACK_MAX_WIDTH bits, the widths given to
+// playback_open() are the bits of the file.
+
+`ifndef PLAYBACK_DPI_VH
+`define PLAYBACK_DPI_VH
+
+`define PLAYBACK_MAX_WIDTH 512
+
+`endif
+
+// mode "w" or "r", null when the file can not be opened
+import "DPI-C" function chandle playback_open(input string name, input string mode,
+                                              input int inputwidth, input int outputwidth);
+import "DPI-C" function void playback_write(input chandle pb,
+                                            input logic [`PLAYBACK_MAX_WIDTH-1:0] in,
+                                            input logic [`PLAYBACK_MAX_WIDTH-1:0] out);
+// 1 with the next record, 0 at the end of the stimulus
+import "DPI-C" function int playback_read(input chandle pb,
+                                          output logic [`PLAYBACK_MAX_WIDTH-1:0] in,
+                                          output logic [`PLAYBACK_MAX_WIDTH-1:0] out);
+import "DPI-C" function void playback_close(input chandle pb);
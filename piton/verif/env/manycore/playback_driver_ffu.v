@@ -60,17 +60,45 @@ integer fid, code;
 integer	mismatch;
 integer cycle;
 
+`ifdef PLAYBACK_DPI
+// binary or text +stim_file through tools/pli/playback, read ahead on a
+// thread of its own
+`include "playback_dpi.vh"
+chandle pb;
+string stimname;
+reg [`PLAYBACK_MAX_WIDTH-1:0] pb_in;
+reg [`PLAYBACK_MAX_WIDTH-1:0] pb_out;
+
+initial begin
+  stimname = "not_provided";
+  void'($value$plusargs("stim_file=%s", stimname));
+  pb = playback_open(stimname, "r", inputwidth, outputwidth);
+  if(pb == null)
+    $finish;
+end
+
+final playback_close(pb);
+`else
 initial begin
   fid = $fopen(stimfile, "r");
 end
+`endif
 
 
 always @(posedge clock_vector) begin
   #300;
   input_vector = input_vector_a;
+`ifdef PLAYBACK_DPI
+  code = playback_read(pb, pb_in, pb_out);
+  if(code == 1)
+    input_vector_a = pb_in[inputwidth-1:0];
+`else
   code = $fscanf(fid, "%b\n", input_vector_a);
-  if(code == 0 || code == -1) begin 
-    if(mismatch == 0)
+`endif
+  if(code == 0 || code == -1 || code == -2) begin 
+    if(code == -2)
+      $display("Playback FAILED, corrupt stimulus after %1d mismatches!", mismatch);
+    else if(mismatch == 0)
       $display("Playback PASSED!");
    else
       $display("Playback FAILED with %1d mismatches!", mismatch);
@@ -78,7 +106,11 @@ always @(posedge clock_vector) begin
   end
   @(negedge clock_vector);
   #200;
+`ifdef PLAYBACK_DPI
+  output_vector_ref = pb_out[outputwidth-1:0];
+`else
   $fscanf(fid, "%b\n", output_vector_ref);
+`endif
 end
 
 
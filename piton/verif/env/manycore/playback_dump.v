@@ -28,7 +28,9 @@ reg clk_start;
 reg clk;
 
 initial begin
+`ifndef PLAYBACK_DPI
    fid = $fopen("stimuli.txt","w");
+`endif
    clk_start = 1'b0;
    clk = 1'b0;
    forever #418 clk = ~clk;
@@ -53,15 +55,39 @@ wire [129:0] output_vector = {
 
 wire clock_vector = cmp_top.iop.sparc0.gclk;
 
+`ifdef PLAYBACK_DPI
+// binary stimulus of tools/pli/playback, +playback_file=NAME (default
+// stimuli.pbv, text for .txt, compressed for .gz or .zst)
+`include "playback_dpi.vh"
+chandle pb;
+string pbfile;
+
+initial begin
+  pbfile = "stimuli.pbv";
+  void'($value$plusargs("playback_file=%s", pbfile));
+  pb = playback_open(pbfile, "w", $bits(input_vector), $bits(output_vector));
+end
+
+final playback_close(pb);
+`endif
+
 always @(posedge clk) begin
   if(~clk_start) begin
+`ifdef PLAYBACK_DPI
+    playback_write(pb, input_vector, output_vector);
+`else
     $fdisplay(fid, "%b\n%b\n", input_vector, output_vector);
+`endif
   end
 end
 
 always @(posedge clock_vector) begin
   clk_start = 1'b1;
+`ifdef PLAYBACK_DPI
+  playback_write(pb, input_vector, output_vector);
+`else
   $fdisplay(fid, "%b\n%b\n", input_vector, output_vector);
+`endif
 end
 
 endmodule
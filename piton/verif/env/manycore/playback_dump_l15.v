@@ -29,7 +29,9 @@ reg core_ref_clk;
 reg io_clk;
 
 initial begin
+`ifndef PLAYBACK_DPI
    fid = $fopen("stimuli.txt","w");
+`endif
    clk_start = 1'b0;
    core_ref_clk = 1'b0;
    forever #500 core_ref_clk = ~core_ref_clk;
@@ -83,15 +85,39 @@ wire [370:0] output_vector = {
 
 wire clock_vector = cmp_top.chip.tile0.l15.clk;
 
+`ifdef PLAYBACK_DPI
+// binary stimulus of tools/pli/playback, +playback_file=NAME (default
+// stimuli.pbv, text for .txt, compressed for .gz or .zst)
+`include "playback_dpi.vh"
+chandle pb;
+string pbfile;
+
+initial begin
+  pbfile = "stimuli.pbv";
+  void'($value$plusargs("playback_file=%s", pbfile));
+  pb = playback_open(pbfile, "w", $bits(input_vector) + 1, $bits(output_vector));
+end
+
+final playback_close(pb);
+`endif
+
 always @(posedge core_ref_clk) begin
   if(~clk_start) begin
+`ifdef PLAYBACK_DPI
+    playback_write(pb, {1'b0,input_vector}, output_vector);
+`else
     $fdisplay(fid, "%b\n%b\n", {1'b0,input_vector}, output_vector);
+`endif
   end
 end
 
 always @(posedge clock_vector) begin
   clk_start = 1'b1;
+`ifdef PLAYBACK_DPI
+  playback_write(pb, {1'b1,input_vector}, output_vector);
+`else
   $fdisplay(fid, "%b\n%b\n", {1'b1,input_vector}, output_vector);
+`endif
 end
 
 endmodule